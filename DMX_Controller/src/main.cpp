@@ -3,23 +3,79 @@
 #include <AsyncTCP.h>
 #include <ESPAsyncWebServer.h>
 #include <WiFi.h>
+#include <AsyncUDP.h>
 #include <arduinojson.h>
+#include <esp_timer.h>
+#include "ESP32S3DMXTX.h"
 
+#define DMX_UART 1
 #define DMX_TX_PIN 10
 #define DMX_DE_PIN 4
 #define DMX_RE_PIN 5
 
-#define DMX_CHANNELS 24 // 6*4=24 channels for RGBWUV lights
-#define DMX_INTERVAL 30  // milliseconds
-
-uint8_t dmxData[DMX_CHANNELS + 1];  // +1 for start code
-unsigned long lastDMXTime = 0;
+#define DMX_OUTPUT_CHANNELS DMX_CHANNELS // full 512-slot universe
+#define DMX_PATCH_DEFAULT 24 // 6*4=24 channels for RGBWUV lights
+#define DMX_MIN_FRAME_US 1204 // shortest break-to-break time allowed by DMX512
+#define DMX_FRAME_HEADROOM_US (2 * DMX_SLOT_US) // slack for tick jitter on top of the wire time
+#define EFFECT_INTERVAL 30  // milliseconds between effect animation steps
+#define DMX_REFRESH_HZ_DEFAULT 40  // output frames per second
+#define DMX_TASK_PRIORITY (configMAX_PRIORITIES - 2)
+#define DMX_TASK_STACK 4096
+
+uint8_t dmxData[DMX_OUTPUT_CHANNELS + 1];  // +1 for start code
+unsigned long lastEffectTime = 0;
+
+// ===== DMX output task =====
+TaskHandle_t dmxTaskHandle = nullptr;
+esp_timer_handle_t dmxTimer = nullptr;
+uint16_t dmxRefreshHz = DMX_REFRESH_HZ_DEFAULT;
+uint32_t dmxPeriodUs = 1000000 / DMX_REFRESH_HZ_DEFAULT;
+
+// ===== Patch =====
+uint16_t dmxPatchSize = DMX_PATCH_DEFAULT; // highest patched slot, effects run over 1..patch
+bool dmxAdaptive = true; // send only up to the highest patched slot at the fastest matching rate
+
+// output timing statistics, written by the DMX task only
+float dmxAchievedHz = 0;        // frames sent in the last second
+uint32_t dmxMaxJitterUs = 0;    // worst |tick interval - period| since last reset
+uint32_t dmxFramesSkipped = 0;  // ticks where the previous frame was still on the wire
+uint32_t effectCycles = 0;      // CPU cycles of the last effect step
+uint32_t composeCycles = 0;     // CPU cycles of the last layer compose
+uint32_t maxEffectCycles = 0;   // worst effect step + compose since last reset
+
+// The C3 has no FPU, so effects run on integer math: a 256-entry sine table
+// indexed by the top 8 bits of a 16-bit phase accumulator.
+uint8_t sineTable[256]; // (sin + 1) / 2 scaled to 0..255
 
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
 
-// slider values
-int sliders[DMX_CHANNELS] = {};  // R,G,B,W
+ESP32S3DMXTX dmxTx;
+
+// ===== Effect layers =====
+// Every effect renders into its own layer; composeLayers() merges them into
+// dmxData once per output frame. The highest priority layer driving a channel
+// wins, layers of equal priority merge HTP (highest value) or LTP (the layer
+// started or moved last).
+#define LAYER_MANUAL 0
+#define LAYER_WAVE 1
+#define LAYER_CHASER 2
+#define LAYER_BREATH 3
+#define LAYER_SCENE 4
+#define LAYER_NETWORK 5
+#define LAYER_COUNT 6
+
+enum LayerMerge : uint8_t { MERGE_HTP, MERGE_LTP };
+
+struct EffectLayer {
+    const char* name;
+    uint8_t priority;
+    LayerMerge merge;
+    bool enabled;               // running or fading out; disabled layers don't take part
+    uint32_t stamp;             // millis() of the last start or manual move, orders LTP
+    const uint8_t* mask;        // channels the layer drives, nullptr for all
+    uint8_t values[DMX_OUTPUT_CHANNELS];
+};
 
 // wave mode variables
 bool waveActive = false;
@@ -30,8 +86,6 @@ const int FADE_INTERVAL = 30; // ms per fade step
 const int FADE_STEP = 15;     // how fast values fade
 int waveStep = 0;
 int waveInterval = 100;  // default ms
-float waveValues[DMX_CHANNELS] = {}; // use float for smooth fading
-const float WAVE_STEP = 15.0; // fade speed per step
 
 // ===== Chaser variables =====
 bool chaserActive = false;
@@ -40,8 +94,7 @@ unsigned long chaserLastTime = 0;
 const int CHASER_INTERVAL_DEFAULT = 100;  // ms
 int chaserInterval = CHASER_INTERVAL_DEFAULT;
 int chaserStep = 0;
-float chaserValues[DMX_CHANNELS] = {}; // use float for smooth fading
-const float CHASER_STEP = 15.0; // how fast channels fade
+const int CHASER_STEP = 15; // how fast channels fade
 
 // ===== Breath Effect Variables =====
 bool breathActive = false;
@@ -49,16 +102,139 @@ bool breathFading = false;
 unsigned long breathLastTime = 0;
 const int BREATH_INTERVAL_DEFAULT = 30;  // update interval in ms
 int breathInterval = BREATH_INTERVAL_DEFAULT;
-float breathPhase = 0.0; // phase of sine wave
-float breathSpeed = 0.05; // speed of the breathing
+uint16_t breathPhase = 0; // phase of sine wave, 65536 = one full cycle
+uint16_t breathPhaseStep = 521; // phase advance per update, ~0.05 rad
 int breathMin = 10;
 int breathMax = 255;
 bool breathIncreasing = true;
-int breathChannels[512] = {}; // store whether each channel is active
+uint8_t breathChannels[DMX_OUTPUT_CHANNELS] = {}; // store whether each channel is active
+
+EffectLayer layers[LAYER_COUNT] = {
+    {"manual", 0, MERGE_HTP, true},   // sliders, R,G,B,W
+    {"wave", 0, MERGE_HTP},
+    {"chaser", 0, MERGE_HTP},
+    {"breath", 0, MERGE_HTP, false, 0, breathChannels},
+    {"scene", 0, MERGE_HTP},
+    {"network", 0, MERGE_HTP},
+};
+
+// ===== Network input =====
+// Art-Net (ArtDmx) and sACN (E1.31) packets are copied straight from the
+// AsyncUDP receive buffer into the network layer. Both protocols feed the
+// same layer, so if both are sent the latest packet wins.
+#define ARTNET_PORT 6454
+#define ARTNET_OP_DMX 0x5000
+#define ARTNET_HEADER_SIZE 18
+#define SACN_PORT 5568
+#define SACN_HEADER_SIZE 126
+#define SACN_OPT_PREVIEW 0x80
+#define SACN_OPT_TERMINATED 0x40
+#define NET_TIMEOUT_MS 2500 // network layer drops out after this long without data (E1.31 data loss timeout)
+
+AsyncUDP artnetUdp;
+AsyncUDP sacnUdp;
+bool netEnabled = true;
+uint16_t artnetUniverse = 0;  // 15-bit port-address, Net:SubNet:Universe
+uint16_t sacnUniverse = 1;    // 1..63999
+
+// netLastPacketMs and the network layer's enabled flag change together:
+// packets enable it on the UDP task, the timeout in loop() disables it.
+// Levels are staged under the same lock and taken by the DMX task before it
+// composes, so a frame never mixes two packets.
+portMUX_TYPE netMux = portMUX_INITIALIZER_UNLOCKED;
+uint8_t netStaging[DMX_OUTPUT_CHANNELS]; // newest packet's levels, guarded by netMux
+bool netStaged = false;                  // netStaging holds levels not yet in the layer
+volatile unsigned long netLastPacketMs = 0;
+volatile int64_t netRxUs = 0;     // arrival of the newest packet not yet on the wire
+volatile bool netPending = false; // a packet arrived since the last frame was sent
+uint8_t artnetLastSeq = 0;
+uint8_t sacnLastSeq = 0;
+bool artnetSeqValid = false;
+bool sacnSeqValid = false;
+
+// network statistics
+uint32_t netPackets = 0;      // accepted data packets
+uint32_t netDropped = 0;      // packets missing from the sequence
+uint32_t netOutOfOrder = 0;   // late or duplicate sACN packets that were discarded
+uint32_t netLatencyUs = 0;    // packet arrival to start of the next frame on the wire
+uint32_t netMaxLatencyUs = 0;
+
+// ===== Scenes =====
+// Scenes are stored one file per slot as a 4 byte magic, a u16 slot count and
+// the slot values, so recall is a single file read whatever is stored. The
+// crossfade runs in the DMX task: at fade start each channel gets a 16.16
+// fixed-point step, after that every frame costs one add per channel.
+#define SCENE_MAX 32
+#define SCENE_MAGIC "SCN1"
+
+uint8_t sceneTarget[DMX_OUTPUT_CHANNELS];  // written by the web task, copied at fade start
+volatile uint32_t sceneFadeFrames = 0;     // frames for the requested fade
+volatile bool sceneRelease = false;        // the request fades the scene out and disables it
+volatile uint32_t sceneRequest = 0;        // bumped by the web task for each recall or release
+uint32_t sceneApplied = 0;                 // last request picked up by the DMX task
+uint8_t sceneFadeTarget[DMX_OUTPUT_CHANNELS]; // DMX task's copy of the running fade's target
+bool sceneReleasing = false;               // running fade ends with the layer disabled
+int32_t sceneLevel[DMX_OUTPUT_CHANNELS];   // 16.16 current scene levels
+int32_t sceneStep[DMX_OUTPUT_CHANNELS];    // 16.16 per-frame step of the running fade
+uint32_t sceneFadeLeft = 0;                // frames until the fade lands on target
+int sceneCurrent = -1;                     // last recalled slot
 
 
 bool ledState = false;
 
+// ===== Binary WebSocket protocol =====
+// A binary frame is a sequence of records, each starting with an opcode.
+// Multi-byte fields are little endian, channels are 1-based.
+//   WS_OP_CHANNELS     start:u16 count:u16 value[count]      manual channel run
+//   WS_OP_CHANNEL_SET  n:u8 (channel:u16 value:u8)[n]        sparse manual channels
+//   WS_OP_OUTPUT       start:u16 count:u16 value[count]      live output levels, sent only
+//   WS_OP_EFFECT       layer:u8 param:u8 value:u16           effect parameter
+//   WS_OP_BREATH_MASK  start:u16 count:u16 bits[(count+7)/8] breath channels, LSB first
+//   WS_OP_LAYER        layer:u8 priority:u8 merge:u8         layer merge settings
+// Parsing stops at the first unknown or truncated record.
+#define WS_OP_CHANNELS 0x01
+#define WS_OP_CHANNEL_SET 0x02
+#define WS_OP_OUTPUT 0x03
+#define WS_OP_EFFECT 0x10
+#define WS_OP_BREATH_MASK 0x11
+#define WS_OP_LAYER 0x12
+
+#define WS_PARAM_ACTIVE 0 // 0 = stop and fade out, 1 = start
+#define WS_PARAM_SPEED 1  // wave/chaser step in ms, breath in 1/100 rad per update
+#define WS_PARAM_MIN 2    // breath only
+#define WS_PARAM_MAX 3    // breath only
+
+// ===== Client state sync =====
+// loop() diffs manual channels, live output and effect settings against what
+// clients last saw and broadcasts the changes as one binary frame at most
+// every SYNC_INTERVAL. New clients get a full snapshot on connect.
+#define SYNC_INTERVAL 50 // ms, 20 Hz
+#define SYNC_RUN_GAP 4   // unchanged slots bridged inside a run, cheaper than a new record header
+#define SYNC_BUFFER_SIZE (2 * (5 + DMX_OUTPUT_CHANNELS) + LAYER_COUNT * 4 * 5)
+
+struct EffectState {
+    bool active[LAYER_COUNT];
+    uint16_t speed[LAYER_COUNT];
+    uint8_t breathMin;
+    uint8_t breathMax;
+};
+
+uint8_t syncedManual[DMX_OUTPUT_CHANNELS];
+uint8_t syncedOutput[DMX_OUTPUT_CHANNELS];
+EffectState syncedEffects;
+uint8_t syncBuffer[SYNC_BUFFER_SIZE];     // loop() diffs
+uint8_t snapshotBuffer[SYNC_BUFFER_SIZE]; // AsyncTCP connect snapshots
+unsigned long lastSyncTime = 0;
+
+// Messages that arrive in several chunks or frames are collected here, one
+// client at a time, and handled once complete. Anything larger than a full
+// sync frame is dropped.
+uint8_t wsRxBuffer[SYNC_BUFFER_SIZE + 1]; // + text terminator
+size_t wsRxLen = 0;
+uint32_t wsRxClient = 0;
+bool wsRxActive = false;                  // a fragmented message is being collected
+uint32_t wsRxDropped = 0;                 // fragmented messages too large or interleaved
+
 // ===== struct Declarations =====
 struct WifiCredentials {
     const char* ssid;
@@ -73,20 +249,52 @@ void setupWebServerRoutes();
 String processor(const String& var);
 void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
              AwsEventType type, void *arg, uint8_t *data, size_t len);
-void handleWebSocketMessage(void *arg, uint8_t *data, size_t len);
+void handleWebSocketMessage(AsyncWebSocketClient *client, void *arg, uint8_t *data, size_t len);
+void handleBinaryMessage(const uint8_t *data, size_t len);
+void setEffectActive(uint8_t layer, bool on);
+bool saveScene(int slot);
+bool recallScene(int slot, uint32_t fadeMs);
+void releaseScene(uint32_t fadeMs);
+bool deleteScene(int slot);
+String scenePath(int slot);
+void startNetworkInput();
+void handleArtnetPacket(AsyncUDPPacket &packet);
+void handleSacnPacket(AsyncUDPPacket &packet);
+void applyNetworkData(const uint8_t *data, uint16_t count);
+void takeNetworkData();
+void countSequence(uint8_t seq, uint8_t &last, bool &valid);
+void handleSceneFade();
+void syncClients();
+void sendSnapshot(AsyncWebSocketClient *client);
+size_t writeChannelDiff(uint8_t *out, uint8_t op, const uint8_t *current, uint8_t *synced, bool full);
+size_t writeEffectDiff(uint8_t *out, EffectState &synced, bool full);
+void readEffectState(EffectState &state);
 void notifyClients();
 WifiCredentials readJSON(const char* path);
 void writeJSON(const char* path);
 
-void updateDMXFromSliders();
-void sendDMX();
+void composeLayers();
+void startLayer(uint8_t layer);
+bool fadeLayer(uint8_t layer);
+int findLayer(const String& name);
+bool sendDMX();
 void handleWave();
-void handleDMXUpdate();
+bool handleDMXUpdate();
 void handleWaveFade();
 void handleChaserFade();
 void handleChaser();
 void handleBreathFade();
 void handleBreath();
+void handleEffects();
+void initSineTable();
+void dmxOutputTask(void *param);
+void startDMXOutput();
+bool setDMXRefreshRate(uint16_t hz);
+uint16_t dmxMaxRefreshHz();
+uint16_t dmxFrameSize();
+void setDMXPatch(uint16_t patch, bool adaptive);
+void readDMXConfig(const char* path);
+void writeDMXConfig(const char* path);
 
 // ===== Setup =====
 void setup() {
@@ -102,57 +310,220 @@ void setup() {
     connectWifi();
     setupWebServerRoutes();
 
-    pinMode(DMX_DE_PIN, OUTPUT);
+    // transmit only: receiver disabled, driver enabled by dmxTx
     pinMode(DMX_RE_PIN, OUTPUT);
-    digitalWrite(DMX_DE_PIN, LOW);
-    digitalWrite(DMX_RE_PIN, LOW);
+    digitalWrite(DMX_RE_PIN, HIGH);
 
-    Serial1.begin(250000, SERIAL_8N2, -1, DMX_TX_PIN);
+    if (!dmxTx.begin(DMX_UART, DMX_TX_PIN, DMX_DE_PIN)) {
+        Serial.println("DMX transmitter init failed");
+    }
 
     // Initialize DMX frame
-    for (int i = 0; i <= DMX_CHANNELS; i++) dmxData[i] = 0;
+    for (int i = 0; i <= DMX_OUTPUT_CHANNELS; i++) dmxData[i] = 0;
+    initSineTable();
+
+    readDMXConfig("/dmx.json");
+    startDMXOutput();
+    startNetworkInput();
 
     Serial.println("Setup complete!");
 }
 
 // ===== Loop =====
 void loop() {
-    handleDMXUpdate();
+    // DMX output runs in dmxOutputTask, the web server in AsyncTCP;
+    // loop() only pushes state changes to the web clients
+    unsigned long now = millis();
+    if (now - lastSyncTime >= SYNC_INTERVAL) {
+        lastSyncTime = now;
+        syncClients();
+        ws.cleanupClients();
+
+        // read the clock under the lock, a packet may have arrived since `now`
+        portENTER_CRITICAL(&netMux);
+        bool timedOut = layers[LAYER_NETWORK].enabled && millis() - netLastPacketMs > NET_TIMEOUT_MS;
+        if (timedOut) layers[LAYER_NETWORK].enabled = false;
+        portEXIT_CRITICAL(&netMux);
+        if (timedOut) Serial.println("Network input timed out");
+    }
+    vTaskDelay(pdMS_TO_TICKS(5));
 }
 
-// ===== DMX Update Logic =====
-void handleDMXUpdate() {
-    unsigned long now = millis();
+// ===== DMX Output Task =====
+// esp_timer wakes the task once per output period; the task runs at high
+// priority so WiFi, SPIFFS and WebSocket work can't delay frames.
+void startDMXOutput() {
+    xTaskCreate(dmxOutputTask, "dmxOutput", DMX_TASK_STACK, nullptr,
+                DMX_TASK_PRIORITY, &dmxTaskHandle);
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = [](void *) { xTaskNotifyGive(dmxTaskHandle); };
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "dmxTick";
+    timerArgs.skip_unhandled_events = true;
+    esp_timer_create(&timerArgs, &dmxTimer);
+
+    setDMXRefreshRate(dmxAdaptive ? dmxMaxRefreshHz() : dmxRefreshHz);
+}
 
-    if (now - lastDMXTime >= DMX_INTERVAL) {
-        lastDMXTime = now;
+// bytes per frame: start code + patched slots in adaptive mode, else the full universe
+uint16_t dmxFrameSize() {
+    return (dmxAdaptive ? dmxPatchSize : DMX_OUTPUT_CHANNELS) + 1;
+}
 
-        if (waveActive) {
-            waveFading = false;  // stop fading if wave is active
-            handleWave();
-        } 
-        else if (waveFading) {
-            handleWaveFade();
-        }
+// highest rate the wire and the DMX512 minimum packet time allow for the current
+// frame length, less headroom for a late tick followed by an early one
+uint16_t dmxMaxRefreshHz() {
+    uint32_t frameUs = max(dmxTx.getFrameTime(dmxFrameSize()), (uint32_t)DMX_MIN_FRAME_US);
+    return 1000000 / (frameUs + DMX_FRAME_HEADROOM_US);
+}
+
+// Change the patched range. Slots above the patch are cleared so a full
+// frame never carries stale values; adaptive mode follows with the rate.
+void setDMXPatch(uint16_t patch, bool adaptive) {
+    patch = constrain(patch, 1, DMX_OUTPUT_CHANNELS);
+    for (int i = patch; i < DMX_OUTPUT_CHANNELS; i++) {
+        for (int l = 0; l < LAYER_COUNT; l++) layers[l].values[i] = 0;
+        sceneLevel[i] = 0;
+        sceneStep[i] = 0;
+        dmxData[i + 1] = 0;
+    }
+    waveStep = 0;
+    chaserStep = 0;
+    dmxPatchSize = patch;
+    dmxAdaptive = adaptive;
+
+    setDMXRefreshRate(dmxAdaptive ? dmxMaxRefreshHz() : dmxRefreshHz);
+}
 
-        if (chaserActive) {
-            chaserFading = false;
-            handleChaser();
+bool setDMXRefreshRate(uint16_t hz) {
+    if (hz == 0) return false;
+    hz = min(hz, dmxMaxRefreshHz());
+
+    dmxRefreshHz = hz;
+    dmxPeriodUs = 1000000 / hz;
+    dmxMaxJitterUs = 0;
+    maxEffectCycles = 0;
+
+    if (!dmxTimer) return false;
+    esp_timer_stop(dmxTimer);
+    return esp_timer_start_periodic(dmxTimer, dmxPeriodUs) == ESP_OK;
+}
+
+void dmxOutputTask(void *param) {
+    int64_t lastTick = 0;
+    int64_t rateWindowStart = esp_timer_get_time();
+    uint32_t rateFrames = 0;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        int64_t now = esp_timer_get_time();
+        if (lastTick != 0) {
+            int64_t interval = now - lastTick;
+            uint32_t jitter = (uint32_t)llabs(interval - (int64_t)dmxPeriodUs);
+            if (jitter > dmxMaxJitterUs) dmxMaxJitterUs = jitter;
         }
-        else if (chaserFading) {
-            handleChaserFade();
+        lastTick = now;
+
+        if (handleDMXUpdate()) rateFrames++;
+
+        if (now - rateWindowStart >= 1000000) {
+            dmxAchievedHz = rateFrames * 1000000.0f / (now - rateWindowStart);
+            rateFrames = 0;
+            rateWindowStart = now;
         }
+    }
+}
+
+// ===== DMX Update Logic =====
+// Called once per output frame. Effects animate on their own
+// EFFECT_INTERVAL clock so their speed doesn't depend on the refresh rate.
+// Returns true if the frame went out on the wire.
+bool handleDMXUpdate() {
+    unsigned long now = millis();
+
+    uint32_t start = ESP.getCycleCount();
+    if (now - lastEffectTime >= EFFECT_INTERVAL) {
+        lastEffectTime = now;
+        handleEffects();
+        effectCycles = ESP.getCycleCount() - start;
+    }
+
+    uint32_t composeStart = ESP.getCycleCount();
+    takeNetworkData();
+    handleSceneFade();
+    composeLayers();
+    uint32_t end = ESP.getCycleCount();
+    composeCycles = end - composeStart;
+    if (end - start > maxEffectCycles) maxEffectCycles = end - start;
+
+    return sendDMX();
+}
 
-        if (breathActive) {
-            breathFading = false;
-            handleBreath();
+// ===== Scene Crossfade =====
+// Runs every output frame, so fades are as smooth as the refresh rate allows
+void handleSceneFade() {
+    uint8_t *out = layers[LAYER_SCENE].values;
+
+    if (sceneRequest != sceneApplied) {
+        sceneApplied = sceneRequest;
+        // the web task may already write the next target, the fade uses its own copy
+        memcpy(sceneFadeTarget, sceneTarget, dmxPatchSize);
+        sceneReleasing = sceneRelease;
+        uint32_t frames = sceneFadeFrames ? sceneFadeFrames : 1;
+        for (int i = 0; i < dmxPatchSize; i++) {
+            sceneStep[i] = (((int32_t)sceneFadeTarget[i] << 16) - sceneLevel[i]) / (int32_t)frames;
         }
-        else if (breathFading) {
-            handleBreathFade();
+        sceneFadeLeft = frames;
+        if (!sceneReleasing) startLayer(LAYER_SCENE);
+    }
+    if (sceneFadeLeft == 0) return;
+
+    if (--sceneFadeLeft == 0) {
+        // land exactly on target, whatever the rounding of the steps
+        for (int i = 0; i < dmxPatchSize; i++) {
+            sceneLevel[i] = (int32_t)sceneFadeTarget[i] << 16;
+            out[i] = sceneFadeTarget[i];
         }
+        if (sceneReleasing) layers[LAYER_SCENE].enabled = false;
+        return;
+    }
+    for (int i = 0; i < dmxPatchSize; i++) {
+        sceneLevel[i] += sceneStep[i];
+        out[i] = sceneLevel[i] >> 16;
+    }
+}
+
+void initSineTable() {
+    for (int i = 0; i < 256; i++) {
+        sineTable[i] = (uint8_t)lround((sin(i * 2 * PI / 256) + 1.0) * 127.5);
+    }
+}
+
+void handleEffects() {
+    if (waveActive) {
+        waveFading = false;  // stop fading if wave is active
+        handleWave();
+    } 
+    else if (waveFading) {
+        handleWaveFade();
+    }
 
-        updateDMXFromSliders();
-        sendDMX();
+    if (chaserActive) {
+        chaserFading = false;
+        handleChaser();
+    }
+    else if (chaserFading) {
+        handleChaserFade();
+    }
+
+    if (breathActive) {
+        breathFading = false;
+        handleBreath();
+    }
+    else if (breathFading) {
+        handleBreathFade();
     }
 }
 
@@ -160,46 +531,91 @@ void handleWaveFade() {
     unsigned long now = millis();
     if (now - waveFadeLastTime >= FADE_INTERVAL) {
         waveFadeLastTime = now;
-        bool stillFading = false;
+        if (!fadeLayer(LAYER_WAVE)) waveFading = false; // finished fading
+    }
+}
 
-        for (int i = 0; i < DMX_CHANNELS; i++) {
-            if (sliders[i] > 0) {
-                sliders[i] -= FADE_STEP;
-                if (sliders[i] < 0) sliders[i] = 0;
-                stillFading = true;
-            }
-        }
+// ===== Layers =====
+// Enable a layer and make it the latest for LTP merging
+void startLayer(uint8_t layer) {
+    layers[layer].stamp = millis();
+    layers[layer].enabled = true;
+}
 
-        if (!stillFading) waveFading = false; // finished fading
+// Step a layer towards black; disables it once dark. Returns true while still fading.
+bool fadeLayer(uint8_t layer) {
+    EffectLayer &l = layers[layer];
+    bool stillFading = false;
+
+    for (int i = 0; i < dmxPatchSize; i++) {
+        if (l.values[i] > 0) {
+            l.values[i] = l.values[i] > FADE_STEP ? l.values[i] - FADE_STEP : 0;
+            stillFading = true;
+        }
     }
+
+    if (!stillFading) l.enabled = false;
+    return stillFading;
 }
 
-// ===== Update DMX Array from Slider Values =====
-void updateDMXFromSliders() {
-  dmxData[0] = 0;
-  for (int i = 0; i < DMX_CHANNELS; i++) {
-      dmxData[i + 1] = sliders[i];
-  }
+int findLayer(const String& name) {
+    for (int l = 0; l < LAYER_COUNT; l++) {
+        if (name == layers[l].name) return l;
+    }
+    return -1;
 }
 
-// ===== Send DMX Frame =====
-void sendDMX() {
-    digitalWrite(DMX_RE_PIN, HIGH);  // disable receiver
-    digitalWrite(DMX_DE_PIN, HIGH);  // enable driver
+// ===== Compose Layers into the DMX Frame =====
+// One pass per output frame; the work is patch size x LAYER_COUNT however
+// many effects are running.
+void composeLayers() {
+    dmxData[0] = 0;
+    for (int i = 0; i < dmxPatchSize; i++) {
+        int16_t winPriority = -1;
+        uint32_t winStamp = 0;
+        uint8_t value = 0;
+
+        for (int l = 0; l < LAYER_COUNT; l++) {
+            const EffectLayer &layer = layers[l];
+            if (!layer.enabled || (layer.mask && !layer.mask[i])) continue;
+
+            if (layer.priority > winPriority) {
+                value = layer.values[i];
+                winPriority = layer.priority;
+                winStamp = layer.stamp;
+            }
+            else if (layer.priority == winPriority) {
+                if (layer.merge == MERGE_HTP) {
+                    value = max(value, layer.values[i]);
+                }
+                else if ((int32_t)(layer.stamp - winStamp) >= 0) {
+                    value = layer.values[i];
+                    winStamp = layer.stamp;
+                }
+            }
+        }
 
-    Serial1.end();
-    pinMode(DMX_TX_PIN, OUTPUT);
-    digitalWrite(DMX_TX_PIN, LOW);
-    delayMicroseconds(120);  // break
-    digitalWrite(DMX_TX_PIN, HIGH);
-    delayMicroseconds(12);   // mark after break
+        dmxData[i + 1] = value;
+    }
+}
 
-    Serial1.begin(250000, SERIAL_8N2, -1, DMX_TX_PIN);
-    Serial1.write(dmxData, DMX_CHANNELS + 1);
-    Serial1.flush();
+// ===== Send DMX Frame =====
+// Hands the frame to the UART driver and returns; break and mark after
+// break are generated by the UART hardware. If the previous frame is still
+// on the wire this frame is skipped and the next tick sends fresh data.
+// Returns false if the previous frame was still on the wire and this one was skipped
+bool sendDMX() {
+    if (!dmxTx.write(dmxData, dmxFrameSize())) {
+        dmxFramesSkipped++;
+        return false;
+    }
 
-    digitalWrite(DMX_DE_PIN, LOW);
-    digitalWrite(DMX_RE_PIN, LOW);
+    if (netPending) {
+        netPending = false;
+        netLatencyUs = esp_timer_get_time() - netRxUs;
+        if (netLatencyUs > netMaxLatencyUs) netMaxLatencyUs = netLatencyUs;
+    }
+    return true;
 }
 
 // ===== Handle Wave Mode =====
@@ -207,15 +623,15 @@ void handleWave() {
     unsigned long now = millis();
     if (now - waveLastTime >= waveInterval) {
         waveLastTime = now;
-        waveStep = (waveStep + 1) % DMX_CHANNELS;
+        waveStep = (waveStep + 1) % dmxPatchSize;
+
+        uint8_t *out = layers[LAYER_WAVE].values;
 
         // Reset all channels
-        for (int i = 0; i < DMX_CHANNELS; i++) sliders[i] = 0;
+        for (int i = 0; i < dmxPatchSize; i++) out[i] = 0;
 
         // Activate the current channel fully
-        sliders[waveStep] = 255;
-
-        Serial.printf("Wave step: %d\n", waveStep);
+        out[waveStep] = 255;
     }
 }
 
@@ -223,20 +639,18 @@ void handleChaser() {
     unsigned long now = millis();
     if (now - chaserLastTime >= chaserInterval) {
         chaserLastTime = now;
-        chaserStep = (chaserStep + 1) % DMX_CHANNELS;
-        Serial.printf("Chaser step: %d\n", chaserStep);
+        chaserStep = (chaserStep + 1) % dmxPatchSize;
     }
 
+    uint8_t *out = layers[LAYER_CHASER].values;
+
     // Fade channels smoothly
-    for (int i = 0; i < DMX_CHANNELS; i++) {
+    for (int i = 0; i < dmxPatchSize; i++) {
         if (i == chaserStep) {
-            chaserValues[i] += CHASER_STEP;
-            if (chaserValues[i] > 255) chaserValues[i] = 255;
+            out[i] = out[i] < 255 - CHASER_STEP ? out[i] + CHASER_STEP : 255;
         } else {
-            chaserValues[i] -= CHASER_STEP;
-            if (chaserValues[i] < 0) chaserValues[i] = 0;
+            out[i] = out[i] > CHASER_STEP ? out[i] - CHASER_STEP : 0;
         }
-        sliders[i] = (int)chaserValues[i];
     }
 }
 
@@ -244,18 +658,7 @@ void handleChaserFade() {
     unsigned long now = millis();
     if (now - waveFadeLastTime >= FADE_INTERVAL) {
         waveFadeLastTime = now;
-        bool stillFading = false;
-
-        for (int i = 0; i < DMX_CHANNELS; i++) {
-            if (chaserValues[i] > 0) {
-                chaserValues[i] -= CHASER_STEP;
-                if (chaserValues[i] < 0) chaserValues[i] = 0;
-                sliders[i] = (int)chaserValues[i];
-                stillFading = true;
-            }
-        }
-
-        if (!stillFading) chaserFading = false;
+        if (!fadeLayer(LAYER_CHASER)) chaserFading = false;
     }
 }
 
@@ -265,17 +668,14 @@ void handleBreath() {
         breathLastTime = now;
 
         // Sine wave calculation between min and max
-        float intensity = (sin(breathPhase) + 1.0) / 2.0; // 0 → 1
-        int value = breathMin + intensity * (breathMax - breathMin);
+        uint8_t intensity = sineTable[breathPhase >> 8]; // 0 → 255
+        int value = breathMin + ((intensity * (breathMax - breathMin) + 255) >> 8);
 
-        for (int i = 0; i < DMX_CHANNELS; i++) {
-            if (breathChannels[i]) {
-                sliders[i] = value;
-            }
-        }
+        // the layer mask limits output to the selected channels
+        uint8_t *out = layers[LAYER_BREATH].values;
+        for (int i = 0; i < dmxPatchSize; i++) out[i] = value;
 
-        breathPhase += breathSpeed;
-        if (breathPhase > 2 * PI) breathPhase -= 2 * PI;
+        breathPhase += breathPhaseStep; // wraps at one full cycle
     }
 }
 
@@ -283,17 +683,7 @@ void handleBreathFade() {
     unsigned long now = millis();
     if (now - waveFadeLastTime >= FADE_INTERVAL) {
         waveFadeLastTime = now;
-        bool stillFading = false;
-
-        for (int i = 0; i < DMX_CHANNELS; i++) {
-            if (sliders[i] > 0) {
-                sliders[i] -= FADE_STEP;
-                if (sliders[i] < 0) sliders[i] = 0;
-                stillFading = true;
-            }
-        }
-
-        if (!stillFading) breathFading = false;
+        if (!fadeLayer(LAYER_BREATH)) breathFading = false;
     }
 }
 
@@ -377,6 +767,60 @@ void setupWebServerRoutes() {
         request->send(response);
     });
 
+    server.on("/scenes", HTTP_GET, [](AsyncWebServerRequest *request){
+        DynamicJsonDocument doc(512);
+        JsonArray stored = doc.createNestedArray("stored");
+        for (int slot = 0; slot < SCENE_MAX; slot++) {
+            if (SPIFFS.exists(scenePath(slot))) stored.add(slot);
+        }
+        doc["current"] = sceneCurrent;
+        doc["fading"] = sceneFadeLeft > 0;
+
+        String msg;
+        serializeJson(doc, msg);
+        request->send(200, "application/json", msg);
+    });
+
+    server.on("/stats", HTTP_GET, [](AsyncWebServerRequest *request){
+        DynamicJsonDocument doc(1024);
+        doc["refreshHz"] = dmxRefreshHz;
+        doc["maxRefreshHz"] = dmxMaxRefreshHz();
+        doc["achievedHz"] = dmxAchievedHz;
+        doc["maxJitterUs"] = dmxMaxJitterUs;
+        doc["skipped"] = dmxFramesSkipped;
+        doc["patch"] = dmxPatchSize;
+        doc["adaptive"] = dmxAdaptive;
+        doc["frameSlots"] = dmxFrameSize() - 1;
+        doc["effectCycles"] = effectCycles;
+        doc["composeCycles"] = composeCycles;
+        doc["maxCycles"] = maxEffectCycles;
+
+        JsonObject net = doc.createNestedObject("network");
+        net["enabled"] = netEnabled;
+        net["active"] = layers[LAYER_NETWORK].enabled;
+        net["artnetUniverse"] = artnetUniverse;
+        net["sacnUniverse"] = sacnUniverse;
+        net["packets"] = netPackets;
+        net["dropped"] = netDropped;
+        net["outOfOrder"] = netOutOfOrder;
+        net["latencyUs"] = netLatencyUs;
+        net["maxLatencyUs"] = netMaxLatencyUs;
+        doc["wsDropped"] = wsRxDropped;
+
+        JsonArray layerArr = doc.createNestedArray("layers");
+        for (int l = 0; l < LAYER_COUNT; l++) {
+            JsonObject layer = layerArr.createNestedObject();
+            layer["name"] = layers[l].name;
+            layer["priority"] = layers[l].priority;
+            layer["merge"] = layers[l].merge == MERGE_LTP ? "ltp" : "htp";
+            layer["enabled"] = layers[l].enabled;
+        }
+
+        String msg;
+        serializeJson(doc, msg);
+        request->send(200, "application/json", msg);
+    });
+
     server.on("/save", HTTP_POST, [](AsyncWebServerRequest *request){
     String ssid, pass;
 
@@ -436,21 +880,49 @@ void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
     switch (type) {
         case WS_EVT_CONNECT:
             Serial.printf("WebSocket client #%u connected\n", client->id());
+            sendSnapshot(client);
             break;
         case WS_EVT_DISCONNECT:
             Serial.printf("WebSocket client #%u disconnected\n", client->id());
             break;
         case WS_EVT_DATA:
-            handleWebSocketMessage(arg, data, len);
+            handleWebSocketMessage(client, arg, data, len);
             break;
         default: break;
     }
 }
 
 // ===== Handle Incoming WebSocket Message =====
-void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
+void handleWebSocketMessage(AsyncWebSocketClient *client, void *arg, uint8_t *data, size_t len) {
     AwsFrameInfo *info = (AwsFrameInfo*)arg;
-    if (!(info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT)) return;
+    if (!(info->final && info->num == 0 && info->index == 0 && info->len == len)) {
+        if (info->num == 0 && info->index == 0) {
+            if (wsRxActive) wsRxDropped++; // another client's message was cut short
+            wsRxActive = true;
+            wsRxClient = client->id();
+            wsRxLen = 0;
+        } else if (!wsRxActive || wsRxClient != client->id()) {
+            return; // rest of a message already dropped
+        }
+        if (wsRxLen + len > SYNC_BUFFER_SIZE) {
+            wsRxActive = false;
+            wsRxDropped++;
+            Serial.printf("WebSocket message from client #%u too large, dropped\n", client->id());
+            return;
+        }
+        memcpy(wsRxBuffer + wsRxLen, data, len);
+        wsRxLen += len;
+        if (!info->final || info->index + len < info->len) return;
+        wsRxActive = false;
+        data = wsRxBuffer;
+        len = wsRxLen;
+    }
+    // continuation frames carry the opcode of the message in message_opcode
+    if (info->message_opcode == WS_BINARY) {
+        handleBinaryMessage(data, len);
+        return;
+    }
+    if (info->message_opcode != WS_TEXT) return;
 
     data[len] = 0;
     String msg = (char*)data;
@@ -469,6 +941,7 @@ void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
             } else {
                 // start wave
                 waveActive = true;
+                startLayer(LAYER_WAVE);
                 Serial.println("Wave started");
             }
         }
@@ -485,6 +958,7 @@ void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
                 Serial.println("Chaser stopped, fading out...");
             } else {
                 chaserActive = true;
+                startLayer(LAYER_CHASER);
                 Serial.println("Chaser started");
             }
         }
@@ -501,12 +975,14 @@ void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
                 Serial.println("Breath effect stopped, fading out...");
             } else {
                 breathActive = true;
+                startLayer(LAYER_BREATH);
                 Serial.println("Breath effect started");
             }
         }
         else if (msg.startsWith("breath:speed:")) {
-            breathSpeed = msg.substring(13).toFloat() / 100.0;
-            Serial.printf("Breath speed set to %.2f\n", breathSpeed);
+            // speed is given in 1/100 rad per update, 628 = one full cycle
+            breathPhaseStep = constrain(msg.substring(13).toInt(), 1, 627) * 65536L / 628;
+            Serial.printf("Breath speed set to %d/65536 cycle\n", breathPhaseStep);
         }
         else if (msg.startsWith("breath:min:")) {
             breathMin = msg.substring(11).toInt();
@@ -518,13 +994,13 @@ void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
         }
         else if (msg.startsWith("breath:channels:")) {
             String list = msg.substring(16);
-            for (int i = 0; i < 512; i++) breathChannels[i] = 0;
+            for (int i = 0; i < DMX_OUTPUT_CHANNELS; i++) breathChannels[i] = 0;
             int start = 0;
             while (start >= 0) {
                 int comma = list.indexOf(',', start);
                 String token = (comma == -1) ? list.substring(start) : list.substring(start, comma);
                 int ch = token.toInt();
-                if (ch >= 1 && ch <= DMX_CHANNELS) breathChannels[ch - 1] = 1;
+                if (ch >= 1 && ch <= DMX_OUTPUT_CHANNELS) breathChannels[ch - 1] = 1;
                 if (comma == -1) break;
                 start = comma + 1;
             }
@@ -532,18 +1008,307 @@ void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
             Serial.println(list);
         }
     }
+    else if (msg.startsWith("scene:")) {
+        // scene:save:<slot>, scene:recall:<slot>:<fade ms>, scene:delete:<slot>,
+        // scene:release:<fade ms>
+        int slotStart = msg.indexOf(':', 6) + 1;
+        int slotEnd = msg.indexOf(':', slotStart);
+        int slot = msg.substring(slotStart, slotEnd < 0 ? msg.length() : slotEnd).toInt();
+
+        if (msg.startsWith("scene:save:")) {
+            Serial.printf("Scene %d %s\n", slot, saveScene(slot) ? "saved" : "save failed");
+        }
+        else if (msg.startsWith("scene:recall:")) {
+            uint32_t fadeMs = slotEnd < 0 ? 0 : msg.substring(slotEnd + 1).toInt();
+            Serial.printf("Scene %d %s, %u ms fade\n", slot,
+                          recallScene(slot, fadeMs) ? "recalled" : "not found", fadeMs);
+        }
+        else if (msg.startsWith("scene:delete:")) {
+            deleteScene(slot);
+            Serial.printf("Scene %d deleted\n", slot);
+        }
+        else if (msg.startsWith("scene:release:")) {
+            uint32_t fadeMs = msg.substring(14).toInt();
+            releaseScene(fadeMs);
+            Serial.printf("Scene released, %u ms fade\n", fadeMs);
+        }
+    }
+    else if (msg.startsWith("net:")) {
+        // net:artnet:<port-address>, net:sacn:<universe>, net:enable:<0|1>, net:reset
+        // the sACN universe is a multicast group joined at boot and applies after
+        // a restart, everything else at once
+        if (msg.startsWith("net:artnet:")) {
+            artnetUniverse = constrain(msg.substring(11).toInt(), 0, 32767);
+        }
+        else if (msg.startsWith("net:sacn:")) {
+            sacnUniverse = constrain(msg.substring(9).toInt(), 1, 63999);
+        }
+        else if (msg.startsWith("net:enable:")) {
+            // switching off drops the network layer right away
+            bool on = msg.substring(11).toInt() != 0;
+            portENTER_CRITICAL(&netMux);
+            netEnabled = on;
+            if (!netEnabled) layers[LAYER_NETWORK].enabled = false;
+            portEXIT_CRITICAL(&netMux);
+            artnetSeqValid = false;
+            sacnSeqValid = false;
+        }
+        else if (msg == "net:reset") {
+            netPackets = netDropped = netOutOfOrder = 0;
+            netMaxLatencyUs = 0;
+            return;
+        }
+        Serial.printf("Network input %s, Art-Net %u, sACN %u\n",
+                      netEnabled ? "on" : "off", artnetUniverse, sacnUniverse);
+        writeDMXConfig("/dmx.json");
+    }
+    else if (msg.startsWith("layer:")) {
+        // layer:<name>:priority:<0-255> or layer:<name>:merge:<htp|ltp>
+        int nameEnd = msg.indexOf(':', 6);
+        int layer = findLayer(msg.substring(6, nameEnd));
+        if (nameEnd < 0 || layer < 0) return;
+        String setting = msg.substring(nameEnd + 1);
+
+        if (setting.startsWith("priority:")) {
+            layers[layer].priority = constrain(setting.substring(9).toInt(), 0, 255);
+        }
+        else if (setting.startsWith("merge:")) {
+            layers[layer].merge = setting.substring(6) == "ltp" ? MERGE_LTP : MERGE_HTP;
+        }
+        Serial.printf("Layer %s: priority %d, %s\n", layers[layer].name,
+                      layers[layer].priority, layers[layer].merge == MERGE_LTP ? "LTP" : "HTP");
+        writeDMXConfig("/dmx.json");
+    }
+    else if (msg.startsWith("dmx:rate:")) {
+        setDMXRefreshRate(msg.substring(9).toInt());
+        Serial.printf("DMX refresh rate set to %d Hz\n", dmxRefreshHz);
+        writeDMXConfig("/dmx.json");
+    }
+    else if (msg.startsWith("dmx:patch:")) {
+        setDMXPatch(msg.substring(10).toInt(), dmxAdaptive);
+        Serial.printf("DMX patch set to %d slots, %d Hz\n", dmxPatchSize, dmxRefreshHz);
+        writeDMXConfig("/dmx.json");
+    }
+    else if (msg.startsWith("dmx:adaptive:")) {
+        setDMXPatch(dmxPatchSize, msg.substring(13).toInt() != 0);
+        Serial.printf("DMX adaptive frame length %s, %d Hz\n", dmxAdaptive ? "on" : "off", dmxRefreshHz);
+        writeDMXConfig("/dmx.json");
+    }
     else {
         int colonIndex = msg.indexOf(':');
         if (colonIndex > 0) {
             int sliderNum = msg.substring(0, colonIndex).toInt();
             int value = msg.substring(colonIndex + 1).toInt();
 
-            if (sliderNum >= 1 && sliderNum <= DMX_CHANNELS) {
-                sliders[sliderNum - 1] = value;
-                Serial.printf("Slider %d -> %d\n", sliderNum, value);
+            if (sliderNum >= 1 && sliderNum <= dmxPatchSize) {
+                layers[LAYER_MANUAL].values[sliderNum - 1] = constrain(value, 0, 255);
+                layers[LAYER_MANUAL].stamp = millis();
+            }
+        }
+    }
+}
+
+// ===== Handle Binary WebSocket Message =====
+// Parses in place without allocating, see WS_OP_* for the record layout.
+void handleBinaryMessage(const uint8_t *data, size_t len) {
+    const uint8_t *p = data;
+    const uint8_t *end = data + len;
+    bool manualChanged = false;
+    bool configChanged = false;
+
+    while (p < end) {
+        uint8_t op = *p++;
+        size_t left = end - p;
+
+        if (op == WS_OP_CHANNELS && left >= 4) {
+            uint16_t start = p[0] | (p[1] << 8);
+            uint16_t count = p[2] | (p[3] << 8);
+            if (left < 4u + count) break;
+            p += 4;
+            for (uint16_t i = 0; i < count; i++) {
+                uint16_t ch = start + i;
+                if (ch >= 1 && ch <= dmxPatchSize) layers[LAYER_MANUAL].values[ch - 1] = p[i];
+            }
+            p += count;
+            manualChanged = true;
+        }
+        else if (op == WS_OP_CHANNEL_SET && left >= 1) {
+            uint8_t n = p[0];
+            if (left < 1u + n * 3u) break;
+            p++;
+            for (uint8_t i = 0; i < n; i++, p += 3) {
+                uint16_t ch = p[0] | (p[1] << 8);
+                if (ch >= 1 && ch <= dmxPatchSize) layers[LAYER_MANUAL].values[ch - 1] = p[2];
+            }
+            manualChanged = true;
+        }
+        else if (op == WS_OP_EFFECT && left >= 4) {
+            uint8_t layer = p[0];
+            uint8_t param = p[1];
+            uint16_t value = p[2] | (p[3] << 8);
+            p += 4;
+
+            if (param == WS_PARAM_ACTIVE) {
+                setEffectActive(layer, value != 0);
             }
+            else if (param == WS_PARAM_SPEED) {
+                if (layer == LAYER_WAVE) waveInterval = value;
+                else if (layer == LAYER_CHASER) chaserInterval = value;
+                else if (layer == LAYER_BREATH) breathPhaseStep = constrain(value, 1, 627) * 65536L / 628;
+            }
+            else if (param == WS_PARAM_MIN && layer == LAYER_BREATH) {
+                breathMin = min(value, (uint16_t)255);
+            }
+            else if (param == WS_PARAM_MAX && layer == LAYER_BREATH) {
+                breathMax = min(value, (uint16_t)255);
+            }
+        }
+        else if (op == WS_OP_BREATH_MASK && left >= 4) {
+            uint16_t start = p[0] | (p[1] << 8);
+            uint16_t count = p[2] | (p[3] << 8);
+            size_t bytes = (count + 7) / 8;
+            if (left < 4 + bytes) break;
+            p += 4;
+            for (uint16_t i = 0; i < count; i++) {
+                uint16_t ch = start + i;
+                if (ch >= 1 && ch <= DMX_OUTPUT_CHANNELS) breathChannels[ch - 1] = (p[i >> 3] >> (i & 7)) & 1;
+            }
+            p += bytes;
+        }
+        else if (op == WS_OP_LAYER && left >= 3) {
+            if (p[0] < LAYER_COUNT) {
+                layers[p[0]].priority = p[1];
+                layers[p[0]].merge = p[2] ? MERGE_LTP : MERGE_HTP;
+                configChanged = true;
+            }
+            p += 3;
+        }
+        else {
+            break; // unknown opcode or truncated record
+        }
+    }
+
+    if (manualChanged) layers[LAYER_MANUAL].stamp = millis();
+    if (configChanged) writeDMXConfig("/dmx.json");
+}
+
+// ===== Client State Sync =====
+// Broadcast everything that changed since the last sync as one frame
+void syncClients() {
+    if (ws.count() == 0) return;
+
+    size_t len = 0;
+    len += writeChannelDiff(syncBuffer + len, WS_OP_CHANNELS, layers[LAYER_MANUAL].values, syncedManual, false);
+    len += writeChannelDiff(syncBuffer + len, WS_OP_OUTPUT, dmxData + 1, syncedOutput, false);
+    len += writeEffectDiff(syncBuffer + len, syncedEffects, false);
+
+    if (len > 0) ws.binaryAll(syncBuffer, len);
+}
+
+// Full state for one new client; the broadcast baseline is left untouched
+void sendSnapshot(AsyncWebSocketClient *client) {
+    static uint8_t scratchChannels[DMX_OUTPUT_CHANNELS];
+    EffectState scratchEffects = {};
+
+    size_t len = 0;
+    len += writeChannelDiff(snapshotBuffer + len, WS_OP_CHANNELS, layers[LAYER_MANUAL].values, scratchChannels, true);
+    len += writeChannelDiff(snapshotBuffer + len, WS_OP_OUTPUT, dmxData + 1, scratchChannels, true);
+    len += writeEffectDiff(snapshotBuffer + len, scratchEffects, true);
+
+    client->binary(snapshotBuffer, len);
+    client->text(String(ledState));
+}
+
+// Append channel run records for slots that differ from synced (all patched
+// slots when full) and update synced. Nearby runs are merged.
+size_t writeChannelDiff(uint8_t *out, uint8_t op, const uint8_t *current, uint8_t *synced, bool full) {
+    size_t len = 0;
+    int i = 0;
+
+    while (i < dmxPatchSize) {
+        if (!full && current[i] == synced[i]) {
+            i++;
+            continue;
+        }
+
+        // extend the run until SYNC_RUN_GAP unchanged slots in a row
+        int start = i;
+        int last = i;
+        for (int j = i + 1; j < dmxPatchSize && j - last <= SYNC_RUN_GAP; j++) {
+            if (full || current[j] != synced[j]) last = j;
+        }
+        uint16_t count = last - start + 1;
+
+        out[len++] = op;
+        out[len++] = (start + 1) & 0xff;
+        out[len++] = (start + 1) >> 8;
+        out[len++] = count & 0xff;
+        out[len++] = count >> 8;
+        for (int j = start; j <= last; j++) {
+            uint8_t v = current[j]; // read once, other tasks keep writing
+            out[len++] = v;
+            synced[j] = v;
         }
+        i = last + 1;
+    }
+    return len;
+}
+
+void readEffectState(EffectState &state) {
+    state.active[LAYER_MANUAL] = true;
+    state.active[LAYER_WAVE] = waveActive;
+    state.active[LAYER_CHASER] = chaserActive;
+    state.active[LAYER_BREATH] = breathActive;
+    state.active[LAYER_SCENE] = false;
+    state.speed[LAYER_MANUAL] = 0;
+    state.speed[LAYER_WAVE] = waveInterval;
+    state.speed[LAYER_CHASER] = chaserInterval;
+    state.speed[LAYER_BREATH] = (breathPhaseStep * 628L + 32768) >> 16;
+    state.speed[LAYER_SCENE] = 0;
+    state.breathMin = breathMin;
+    state.breathMax = breathMax;
+}
+
+// Append WS_OP_EFFECT records for effect settings that differ from synced
+size_t writeEffectDiff(uint8_t *out, EffectState &synced, bool full) {
+    EffectState now = {};
+    readEffectState(now);
+
+    size_t len = 0;
+    auto put = [&](uint8_t layer, uint8_t param, uint16_t value) {
+        out[len++] = WS_OP_EFFECT;
+        out[len++] = layer;
+        out[len++] = param;
+        out[len++] = value & 0xff;
+        out[len++] = value >> 8;
+    };
+
+    for (int l = LAYER_WAVE; l <= LAYER_BREATH; l++) {
+        if (full || now.active[l] != synced.active[l]) put(l, WS_PARAM_ACTIVE, now.active[l]);
+        if (full || now.speed[l] != synced.speed[l]) put(l, WS_PARAM_SPEED, now.speed[l]);
     }
+    if (full || now.breathMin != synced.breathMin) put(LAYER_BREATH, WS_PARAM_MIN, now.breathMin);
+    if (full || now.breathMax != synced.breathMax) put(LAYER_BREATH, WS_PARAM_MAX, now.breathMax);
+
+    synced = now;
+    return len;
+}
+
+// Start an effect layer or let it fade out
+void setEffectActive(uint8_t layer, bool on) {
+    bool *active;
+    bool *fading;
+    switch (layer) {
+        case LAYER_WAVE:   active = &waveActive;   fading = &waveFading;   break;
+        case LAYER_CHASER: active = &chaserActive; fading = &chaserFading; break;
+        case LAYER_BREATH: active = &breathActive; fading = &breathFading; break;
+        default: return;
+    }
+    if (*active == on) return;
+
+    *active = on;
+    if (on) startLayer(layer);
+    else *fading = true;
 }
 
 // ===== Notify Clients =====
@@ -580,4 +1345,217 @@ void writeJSON(const char* path) {
     }
     serializeJson(doc, file);
     file.close();
+}
+
+// ===== Network Input =====
+// The listeners always run so input can be switched on and off at once;
+// the packet handlers ignore everything while netEnabled is off.
+void startNetworkInput() {
+    if (artnetUdp.listen(ARTNET_PORT)) {
+        artnetUdp.onPacket(handleArtnetPacket);
+        Serial.printf("Art-Net listening on universe %u\n", artnetUniverse);
+    }
+    // sACN is multicast to 239.255.<universe hi>.<universe lo>, unicast also arrives here
+    if (sacnUdp.listenMulticast(IPAddress(239, 255, sacnUniverse >> 8, sacnUniverse & 0xff), SACN_PORT)) {
+        sacnUdp.onPacket(handleSacnPacket);
+        Serial.printf("sACN listening on universe %u\n", sacnUniverse);
+    }
+}
+
+void handleArtnetPacket(AsyncUDPPacket &packet) {
+    const uint8_t *p = packet.data();
+    size_t len = packet.length();
+
+    if (!netEnabled) return;
+    if (len < ARTNET_HEADER_SIZE || memcmp(p, "Art-Net", 8) != 0) return;
+    if ((p[8] | (p[9] << 8)) != ARTNET_OP_DMX) return;
+    if ((p[14] | (p[15] << 8)) != artnetUniverse) return;
+
+    uint16_t count = (p[16] << 8) | p[17];
+    count = min(count, (uint16_t)(len - ARTNET_HEADER_SIZE));
+
+    if (p[12] != 0) countSequence(p[12], artnetLastSeq, artnetSeqValid); // 0 = sequencing disabled
+    applyNetworkData(p + ARTNET_HEADER_SIZE, count);
+}
+
+void handleSacnPacket(AsyncUDPPacket &packet) {
+    const uint8_t *p = packet.data();
+    size_t len = packet.length();
+
+    if (!netEnabled) return;
+    if (len < SACN_HEADER_SIZE || memcmp(p + 4, "ASC-E1.17", 9) != 0) return;
+    if (p[21] != 0x04 || p[43] != 0x02 || p[117] != 0x02) return; // root, framing, DMP data vectors
+    if (((p[113] << 8) | p[114]) != sacnUniverse) return;
+    if (p[125] != 0) return; // only the null start code carries levels
+
+    uint8_t options = p[112];
+    if (options & SACN_OPT_PREVIEW) return;
+    if (options & SACN_OPT_TERMINATED) {
+        portENTER_CRITICAL(&netMux);
+        layers[LAYER_NETWORK].enabled = false;
+        portEXIT_CRITICAL(&netMux);
+        sacnSeqValid = false;
+        return;
+    }
+
+    // E1.31 6.7.2: a packet less than 20 behind the last one is late or a duplicate
+    uint8_t seq = p[111];
+    if (sacnSeqValid) {
+        int8_t diff = (int8_t)(seq - sacnLastSeq);
+        if (diff <= 0 && diff > -20) {
+            netOutOfOrder++;
+            return;
+        }
+    }
+    countSequence(seq, sacnLastSeq, sacnSeqValid);
+
+    uint16_t count = ((p[123] << 8) | p[124]) - 1; // property count includes the start code
+    count = min(count, (uint16_t)(len - SACN_HEADER_SIZE));
+    applyNetworkData(p + SACN_HEADER_SIZE, count);
+}
+
+// Count the packets missing between the last sequence number and this one
+void countSequence(uint8_t seq, uint8_t &last, bool &valid) {
+    uint8_t gap = seq - last - 1;
+    if (valid && gap < 128) netDropped += gap;
+    last = seq;
+    valid = true;
+}
+
+// Levels go from the receive buffer into netStaging, a newer packet
+// replaces one the DMX task has not taken yet
+void applyNetworkData(const uint8_t *data, uint16_t count) {
+    count = min(count, (uint16_t)DMX_OUTPUT_CHANNELS);
+
+    netRxUs = esp_timer_get_time();
+    netPending = true;
+    netPackets++;
+    portENTER_CRITICAL(&netMux);
+    memcpy(netStaging, data, count);
+    memset(netStaging + count, 0, DMX_OUTPUT_CHANNELS - count);
+    netStaged = true;
+    netLastPacketMs = millis();
+    // input may have been switched off while this packet was being parsed
+    if (netEnabled && !layers[LAYER_NETWORK].enabled) startLayer(LAYER_NETWORK);
+    portEXIT_CRITICAL(&netMux);
+}
+
+// Called by the DMX task before composing: the whole packet or nothing
+void takeNetworkData() {
+    portENTER_CRITICAL(&netMux);
+    if (netStaged) {
+        memcpy(layers[LAYER_NETWORK].values, netStaging, dmxPatchSize);
+        netStaged = false;
+    }
+    portEXIT_CRITICAL(&netMux);
+}
+
+// ===== Scene Storage =====
+String scenePath(int slot) {
+    return "/scene" + String(slot) + ".bin";
+}
+
+// Store the current composed output of the patched channels
+bool saveScene(int slot) {
+    if (slot < 0 || slot >= SCENE_MAX) return false;
+
+    File file = SPIFFS.open(scenePath(slot), "w");
+    if (!file) return false;
+
+    uint8_t header[6] = { SCENE_MAGIC[0], SCENE_MAGIC[1], SCENE_MAGIC[2], SCENE_MAGIC[3],
+                          (uint8_t)(dmxPatchSize & 0xff), (uint8_t)(dmxPatchSize >> 8) };
+    bool ok = file.write(header, sizeof(header)) == sizeof(header)
+           && file.write(dmxData + 1, dmxPatchSize) == dmxPatchSize;
+    file.close();
+    return ok;
+}
+
+// Load a scene and hand it to the DMX task as the new crossfade target
+bool recallScene(int slot, uint32_t fadeMs) {
+    if (slot < 0 || slot >= SCENE_MAX) return false;
+
+    File file = SPIFFS.open(scenePath(slot), "r");
+    if (!file) return false;
+
+    uint8_t header[6];
+    if (file.read(header, sizeof(header)) != sizeof(header) || memcmp(header, SCENE_MAGIC, 4) != 0) {
+        file.close();
+        return false;
+    }
+    uint16_t count = min((uint16_t)(header[4] | (header[5] << 8)), (uint16_t)DMX_OUTPUT_CHANNELS);
+    size_t got = file.read(sceneTarget, count);
+    file.close();
+    memset(sceneTarget + got, 0, DMX_OUTPUT_CHANNELS - got);
+
+    sceneFadeFrames = (uint64_t)fadeMs * dmxRefreshHz / 1000;
+    sceneRelease = false;
+    sceneCurrent = slot;
+    sceneRequest = sceneRequest + 1;
+    return true;
+}
+
+// Fade the scene layer to black, the DMX task disables it once dark
+void releaseScene(uint32_t fadeMs) {
+    memset(sceneTarget, 0, sizeof(sceneTarget));
+    sceneFadeFrames = (uint64_t)fadeMs * dmxRefreshHz / 1000;
+    sceneRelease = true;
+    sceneCurrent = -1;
+    sceneRequest = sceneRequest + 1;
+}
+
+bool deleteScene(int slot) {
+    if (slot < 0 || slot >= SCENE_MAX) return false;
+    if (slot == sceneCurrent) sceneCurrent = -1;
+    return SPIFFS.remove(scenePath(slot));
+}
+
+// ===== DMX Output Config =====
+void readDMXConfig(const char* path) {
+    File file = SPIFFS.open(path, "r");
+    if (!file) {
+        Serial.println("No DMX config, using defaults");
+        return;
+    }
+    DynamicJsonDocument doc(512);
+    deserializeJson(doc, file);
+    file.close();
+
+    dmxPatchSize = constrain((int)(doc["patch"] | DMX_PATCH_DEFAULT), 1, DMX_OUTPUT_CHANNELS);
+    dmxAdaptive = doc["adaptive"] | true;
+    dmxRefreshHz = doc["refresh_hz"] | DMX_REFRESH_HZ_DEFAULT;
+    netEnabled = doc["net_enabled"] | true;
+    artnetUniverse = doc["artnet_universe"] | 0;
+    sacnUniverse = doc["sacn_universe"] | 1;
+
+    for (JsonObject layer : doc["layers"].as<JsonArray>()) {
+        int l = findLayer(layer["name"] | "");
+        if (l < 0) continue;
+        layers[l].priority = layer["priority"] | 0;
+        layers[l].merge = strcmp(layer["merge"] | "htp", "ltp") == 0 ? MERGE_LTP : MERGE_HTP;
+    }
+}
+
+void writeDMXConfig(const char* path) {
+    DynamicJsonDocument doc(512);
+    doc["patch"] = dmxPatchSize;
+    doc["adaptive"] = dmxAdaptive;
+    doc["refresh_hz"] = dmxRefreshHz;
+    doc["net_enabled"] = netEnabled;
+    doc["artnet_universe"] = artnetUniverse;
+    doc["sacn_universe"] = sacnUniverse;
+
+    JsonArray layerArr = doc.createNestedArray("layers");
+    for (int l = 0; l < LAYER_COUNT; l++) {
+        JsonObject layer = layerArr.createNestedObject();
+        layer["name"] = layers[l].name;
+        layer["priority"] = layers[l].priority;
+        layer["merge"] = layers[l].merge == MERGE_LTP ? "ltp" : "htp";
+    }
+    File file = SPIFFS.open(path, "w");
+    if (!file) {
+        Serial.println("Failed to open DMX config for writing");
+        return;
+    }
+    serializeJson(doc, file);
+    file.close();
 }
\ No newline at end of file
@@ -0,0 +1,489 @@
+/**
+ * @file DMXNowPacket.h
+ * @brief ESP-NOW wire format shared by the DMX bridge and its receivers
+ * @version 4.0.0
+ *
+ * Every ESP-NOW packet is a fixed header followed by a variable-length
+ * payload of DMX slot values. Only header + payload bytes are sent, up to
+ * the 250-byte ESP-NOW limit. A window larger than one packet is split
+ * into fragments that share the frame sequence number; DMXNowAssembler
+ * puts them back together on the receiver.
+ *
+ * Packets are broadcast without MAC-layer ACKs or retries. A receiver
+ * only takes packets of its group, so several bridges can share a
+ * channel, and detects loss from gaps in the frame sequence numbers.
+ * Receivers report their link quality back to the bridge in a small
+ * DMXNowTelemetry packet every few seconds.
+ *
+ * A payload is either the raw slot values or, when the header flags say
+ * so, one of two compact encodings:
+ * - RLE: control byte n < 0x80 is followed by n + 1 literal slots,
+ *   n >= 0x80 by one value repeated (n & 0x7F) + 1 times.
+ * - Delta: pairs of (unchanged slots to skip, changed slots) followed by
+ *   the changed values, patching the previous frame (sequence - 1).
+ *   Slots after the last pair are unchanged.
+ * A frame without delta fragments is a keyframe: it does not depend on
+ * earlier frames, so a receiver that missed one resyncs on the next.
+ *
+ * The encoder fills a DMXNowFrame in place: the caller writes slot values
+ * straight into frame.payload and dmxNowFinish() completes the header.
+ * The decoder validates a received buffer with a few compares and returns
+ * pointers into it, so nothing is copied in the receive callback.
+ *
+ * All multi-byte fields are little endian.
+ */
+
+#ifndef DMXNOWPACKET_H
+#define DMXNOWPACKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define DMXNOW_MAGIC 0xD7         ///< First byte of every packet
+#define DMXNOW_TELEMETRY_MAGIC 0xD8 ///< First byte of a receiver link report
+#define DMXNOW_VERSION 4          ///< Wire format version, bumped on incompatible changes
+#define DMXNOW_MAX_PACKET 250     ///< ESP-NOW payload limit
+#define DMXNOW_UNIVERSE_SLOTS 512 ///< Slots in a DMX universe
+#define DMXNOW_REASSEMBLY_TIMEOUT_MS 50 ///< Default time to wait for the rest of a frame
+#define DMXNOW_LATE_WINDOW 20     ///< Sequences this far behind are late, further back means the bridge restarted
+#define DMXNOW_GROUP_DEFAULT 0    ///< Group of a bridge or receiver that was not configured
+
+#define DMXNOW_FLAG_RLE 0x01      ///< Payload is run-length encoded
+#define DMXNOW_FLAG_DELTA 0x02    ///< Payload patches the same slots of frame sequence - 1
+#define DMXNOW_FLAGS_KNOWN (DMXNOW_FLAG_RLE | DMXNOW_FLAG_DELTA)
+
+/**
+ * @brief Packet header, 13 bytes on the wire
+ */
+struct __attribute__((packed)) DMXNowHeader {
+    uint8_t magic;         ///< DMXNOW_MAGIC
+    uint8_t version;       ///< DMXNOW_VERSION
+    uint8_t flags;         ///< Payload encoding, DMXNOW_FLAG_* (0 = raw slots)
+    uint8_t group;         ///< Bridge group, receivers ignore other groups
+    uint8_t universe;      ///< Bridge DMX input the slots were taken from (0 = first)
+    uint16_t sequence;     ///< Per-universe frame counter shared by all fragments, wraps
+    uint16_t start;        ///< DMX slot (1-512) of the first payload byte
+    uint16_t length;       ///< Slots carried, equal to the payload bytes unless encoded
+    uint8_t fragment;      ///< Index of this fragment within the frame
+    uint8_t fragmentCount; ///< Fragments that make up the frame
+};
+
+#define DMXNOW_HEADER_SIZE sizeof(DMXNowHeader)
+#define DMXNOW_MAX_PAYLOAD (DMXNOW_MAX_PACKET - DMXNOW_HEADER_SIZE) ///< 237 slots per packet
+#define DMXNOW_MAX_FRAGMENTS ((DMXNOW_UNIVERSE_SLOTS + DMXNOW_MAX_PAYLOAD - 1) / DMXNOW_MAX_PAYLOAD) ///< 3 for a full universe
+
+/**
+ * @brief Transmit buffer: header and payload laid out as sent
+ */
+struct __attribute__((packed)) DMXNowFrame {
+    DMXNowHeader header;
+    uint8_t payload[DMXNOW_MAX_PAYLOAD];
+};
+
+/**
+ * @brief Link report a receiver sends to the bridge, 24 bytes on the wire
+ *
+ * Counts cover the periodMs before the report, so the bridge needs no
+ * history to show a loss rate.
+ */
+struct __attribute__((packed)) DMXNowTelemetry {
+    uint8_t magic;           ///< DMXNOW_TELEMETRY_MAGIC
+    uint8_t version;         ///< DMXNOW_VERSION
+    uint8_t group;           ///< Group the receiver follows
+    uint8_t universe;        ///< Bridge DMX input the receiver follows
+    uint16_t address;        ///< First slot the receiver uses, 0 = start of the window
+    uint16_t periodMs;       ///< Time covered by the counts
+    uint16_t framesComplete; ///< Frames with all fragments
+    uint16_t framesPartial;  ///< Frames superseded or timed out incomplete
+    uint16_t framesLost;     ///< Sequence numbers without a single fragment
+    uint32_t intervalUs;     ///< Mean time between frames while the bridge sends periodically
+    uint32_t jitterUs;       ///< Inter-arrival jitter of those frames
+    int8_t rssi;             ///< Mean RSSI of the bridge's packets in dBm, 0 = unknown
+    uint8_t renderFps;       ///< Strip refreshes per second
+};
+
+/**
+ * @brief Validate a received link report
+ *
+ * @return const DMXNowTelemetry* Report inside data, or nullptr if it is not one
+ */
+inline const DMXNowTelemetry* dmxNowDecodeTelemetry(const uint8_t *data, int len) {
+    if (len < (int)sizeof(DMXNowTelemetry)) return nullptr;
+    const DMXNowTelemetry *report = (const DMXNowTelemetry *)data;
+    if (report->magic != DMXNOW_TELEMETRY_MAGIC || report->version != DMXNOW_VERSION) return nullptr;
+    return report;
+}
+
+/**
+ * @brief Complete the header of a frame whose payload is already filled
+ *
+ * @param frame Frame to finish
+ * @param universe Bridge DMX input
+ * @param sequence Frame sequence number
+ * @param start DMX slot of payload[0]
+ * @param length Slots in the payload, clamped to DMXNOW_MAX_PAYLOAD
+ * @param fragment Index of this fragment
+ * @param fragmentCount Fragments in the frame
+ * @param flags Payload encoding from dmxNowEncodePayload()
+ * @param size Encoded payload bytes, only used when flags select an encoding
+ * @param group Bridge group
+ * @return size_t Bytes to hand to esp_now_send()
+ */
+inline size_t dmxNowFinish(DMXNowFrame &frame, uint8_t universe, uint16_t sequence,
+                           uint16_t start, uint16_t length,
+                           uint8_t fragment = 0, uint8_t fragmentCount = 1,
+                           uint8_t flags = 0, uint16_t size = 0,
+                           uint8_t group = DMXNOW_GROUP_DEFAULT) {
+    if (length > DMXNOW_MAX_PAYLOAD) length = DMXNOW_MAX_PAYLOAD;
+    if (!flags || size > DMXNOW_MAX_PAYLOAD) size = length;
+    frame.header.magic = DMXNOW_MAGIC;
+    frame.header.version = DMXNOW_VERSION;
+    frame.header.flags = flags;
+    frame.header.group = group;
+    frame.header.universe = universe;
+    frame.header.sequence = sequence;
+    frame.header.start = start;
+    frame.header.length = length;
+    frame.header.fragment = fragment;
+    frame.header.fragmentCount = fragmentCount;
+    return DMXNOW_HEADER_SIZE + size;
+}
+
+/**
+ * @brief Run-length encode slot values
+ *
+ * @return int Encoded bytes, or -1 if they would not fit in outMax
+ */
+inline int dmxNowEncodeRLE(const uint8_t *slots, uint16_t count, uint8_t *out, uint16_t outMax) {
+    uint16_t i = 0, o = 0;
+    while (i < count) {
+        uint16_t run = 1;
+        while (i + run < count && run < 0x80 && slots[i + run] == slots[i]) run++;
+        if (run >= 3) {
+            if (o + 2 > outMax) return -1;
+            out[o++] = 0x80 | (run - 1);
+            out[o++] = slots[i];
+            i += run;
+            continue;
+        }
+
+        // literals up to the next run worth encoding
+        uint16_t literal = 0;
+        while (i + literal < count && literal < 0x80) {
+            uint16_t j = i + literal;
+            if (j + 2 < count && slots[j] == slots[j + 1] && slots[j] == slots[j + 2]) break;
+            literal++;
+        }
+        if (o + 1 + literal > outMax) return -1;
+        out[o++] = literal - 1;
+        memcpy(out + o, slots + i, literal);
+        o += literal;
+        i += literal;
+    }
+    return o;
+}
+
+/**
+ * @brief Expand an RLE payload into exactly count slots
+ *
+ * @return false if the payload is truncated or does not cover count slots
+ */
+inline bool dmxNowDecodeRLE(const uint8_t *in, uint16_t size, uint8_t *slots, uint16_t count) {
+    uint16_t i = 0, o = 0;
+    while (i < size) {
+        uint8_t control = in[i++];
+        uint16_t n = (control & 0x7F) + 1;
+        if (o + n > count) return false;
+        if (control & 0x80) {
+            if (i >= size) return false;
+            memset(slots + o, in[i++], n);
+        } else {
+            if (i + n > size) return false;
+            memcpy(slots + o, in + i, n);
+            i += n;
+        }
+        o += n;
+    }
+    return o == count;
+}
+
+/**
+ * @brief Encode the slots that differ from base
+ *
+ * A single unchanged slot between changes is sent as a value, which is
+ * cheaper than starting a new pair.
+ *
+ * @return int Encoded bytes (0 if nothing changed), or -1 if they would not fit in outMax
+ */
+inline int dmxNowEncodeDelta(const uint8_t *slots, const uint8_t *base, uint16_t count,
+                             uint8_t *out, uint16_t outMax) {
+    uint16_t i = 0, o = 0;
+    while (i < count) {
+        uint16_t skip = 0;
+        while (i + skip < count && skip < 0xFF && slots[i + skip] == base[i + skip]) skip++;
+        if (i + skip == count) break;
+
+        uint16_t changed = 0;
+        while (i + skip + changed < count && changed < 0xFF) {
+            uint16_t j = i + skip + changed;
+            if (slots[j] == base[j] && (j + 1 == count || slots[j + 1] == base[j + 1])) break;
+            changed++;
+        }
+        if (o + 2 + changed > outMax) return -1;
+        out[o++] = skip;
+        out[o++] = changed;
+        memcpy(out + o, slots + i + skip, changed);
+        o += changed;
+        i += skip + changed;
+    }
+    return o;
+}
+
+/**
+ * @brief Patch count slots that hold the previous frame with a delta payload
+ *
+ * @return false if the payload is truncated or addresses slots past count
+ */
+inline bool dmxNowDecodeDelta(const uint8_t *in, uint16_t size, uint8_t *slots, uint16_t count) {
+    uint16_t i = 0, o = 0;
+    while (i < size) {
+        if (i + 2 > size) return false;
+        o += in[i++];
+        uint16_t changed = in[i++];
+        if (o + changed > count || i + changed > size) return false;
+        memcpy(slots + o, in + i, changed);
+        i += changed;
+        o += changed;
+    }
+    return o <= count;
+}
+
+/**
+ * @brief Encode slot values with whichever encoding is smallest
+ *
+ * Tries a delta against base and RLE, and falls back to the raw values
+ * when neither saves a byte.
+ *
+ * @param out Payload to fill, DMXNOW_MAX_PAYLOAD bytes
+ * @param slots Slot values to send, at most DMXNOW_MAX_PAYLOAD
+ * @param base Same slots of the previous frame, nullptr for a keyframe
+ * @param count Slots to encode
+ * @param flags Set to the encoding to pass to dmxNowFinish()
+ * @return uint16_t Payload bytes written to out
+ */
+inline uint16_t dmxNowEncodePayload(uint8_t *out, const uint8_t *slots, const uint8_t *base,
+                                    uint16_t count, uint8_t &flags) {
+    if (count > DMXNOW_MAX_PAYLOAD) count = DMXNOW_MAX_PAYLOAD;
+    int best = count;
+    flags = 0;
+
+    if (base && count > 0) {
+        int size = dmxNowEncodeDelta(slots, base, count, out, best - 1);
+        if (size >= 0) {
+            best = size;
+            flags = DMXNOW_FLAG_DELTA;
+        }
+    }
+    if (best > 0) {
+        uint8_t rle[DMXNOW_MAX_PAYLOAD];
+        int size = dmxNowEncodeRLE(slots, count, rle, best - 1);
+        if (size >= 0) {
+            memcpy(out, rle, size);
+            best = size;
+            flags = DMXNOW_FLAG_RLE;
+        }
+    }
+    if (!flags) memcpy(out, slots, count);
+    return best;
+}
+
+/**
+ * @brief Validate a received packet without copying it
+ *
+ * Rejects packets that are too short, carry another magic or version or
+ * an unknown encoding, announce more raw payload than was received,
+ * address slots outside 1-512 or carry an impossible fragment index.
+ * Encoded payloads are only checked by DMXNowAssembler::add().
+ *
+ * @param data Received bytes
+ * @param len Received length
+ * @param payload Set to the first payload byte on success
+ * @param size Set to the payload bytes on success
+ * @return const DMXNowHeader* Header inside data, or nullptr if malformed
+ */
+inline const DMXNowHeader* dmxNowDecode(const uint8_t *data, int len, const uint8_t **payload,
+                                        uint16_t *size) {
+    if (len < (int)DMXNOW_HEADER_SIZE) return nullptr;
+
+    const DMXNowHeader *header = (const DMXNowHeader *)data;
+    int received = len - (int)DMXNOW_HEADER_SIZE;
+    if (header->magic != DMXNOW_MAGIC || header->version != DMXNOW_VERSION) return nullptr;
+    if ((header->flags & ~DMXNOW_FLAGS_KNOWN) || header->flags == DMXNOW_FLAGS_KNOWN) return nullptr;
+    if (!header->flags && header->length > received) return nullptr;
+    if (header->start == 0 || header->start + header->length - 1 > DMXNOW_UNIVERSE_SLOTS) return nullptr;
+    if (header->fragmentCount == 0 || header->fragmentCount > DMXNOW_MAX_FRAGMENTS ||
+        header->fragment >= header->fragmentCount) return nullptr;
+
+    *payload = data + DMXNOW_HEADER_SIZE;
+    *size = header->flags ? received : header->length;
+    return header;
+}
+
+/**
+ * @class DMXNowAssembler
+ * @brief Reassembles fragmented frames of one universe
+ *
+ * Fragments are written into a universe-sized buffer at their slot offset.
+ * The buffer keeps the previous frame, so slots of a fragment that never
+ * arrives hold their last value. A frame is complete once every fragment
+ * of its sequence number was seen.
+ *
+ * A delta fragment is only applied on top of a complete previous frame;
+ * after a loss, delta fragments are dropped until the next keyframe.
+ *
+ * Partial-frame policy: a frame that is superseded by a newer sequence or
+ * times out is counted; with applyPartial set it is also reported as
+ * FRAME_PARTIAL so the caller can show what did arrive, otherwise it is
+ * dropped.
+ */
+class DMXNowAssembler {
+public:
+    enum Result {
+        FRAGMENT_REJECTED, ///< Late, duplicate or from an older frame
+        FRAGMENT_STORED,   ///< Frame still incomplete
+        FRAME_COMPLETE,    ///< All fragments of the frame arrived
+        FRAME_PARTIAL      ///< Incomplete frame released by the partial-frame policy
+    };
+
+    uint32_t framesComplete = 0;  ///< Frames with all fragments
+    uint32_t framesPartial = 0;   ///< Frames superseded before they were complete
+    uint32_t timeouts = 0;        ///< Frames that timed out waiting for fragments
+    uint32_t lateFragments = 0;   ///< Fragments of older frames or duplicates
+    uint32_t framesLost = 0;      ///< Sequence numbers skipped without a single fragment
+    uint32_t missingBase = 0;     ///< Delta fragments dropped while waiting for a keyframe
+    uint32_t decodeErrors = 0;    ///< Encoded payloads that did not expand to their slot count
+
+    bool applyPartial = false;    ///< Release incomplete frames instead of dropping them
+    uint32_t timeoutMs = DMXNOW_REASSEMBLY_TIMEOUT_MS;
+
+    /**
+     * @brief Store a decoded fragment
+     *
+     * @param header Header returned by dmxNowDecode()
+     * @param payload Payload returned by dmxNowDecode()
+     * @param size Payload bytes returned by dmxNowDecode()
+     * @param nowMs Current time in milliseconds
+     */
+    Result add(const DMXNowHeader &header, const uint8_t *payload, uint16_t size, uint32_t nowMs) {
+        bool superseded = false;
+
+        if (!active || header.sequence != sequence) {
+            int16_t diff = (int16_t)(header.sequence - sequence);
+            if (active && diff < 0 && diff > -DMXNOW_LATE_WINDOW) {
+                lateFragments++;
+                return FRAGMENT_REJECTED;
+            }
+            superseded = active && !complete;
+            if (superseded) framesPartial++;
+            if (active && diff > 1) framesLost += diff - 1;
+
+            // a delta needs every slot of the previous frame
+            hasBase = active && complete && received == allFragments &&
+                      header.sequence == (uint16_t)(sequence + 1);
+            active = true;
+            complete = false;
+            sequence = header.sequence;
+            received = 0;
+            startedMs = nowMs;
+        }
+
+        uint8_t bit = 1 << header.fragment;
+        if (complete || (received & bit)) {
+            lateFragments++;
+            return FRAGMENT_REJECTED;
+        }
+
+        uint8_t *slots = buffer + header.start - 1;
+        if (header.flags) {
+            // expand into scratch so a malformed payload leaves the slots untouched
+            uint8_t scratch[DMXNOW_MAX_PAYLOAD];
+            bool decoded = false;
+            if (header.flags & DMXNOW_FLAG_DELTA) {
+                if (!hasBase) {
+                    missingBase++;
+                    return FRAGMENT_REJECTED;
+                }
+                if (header.length <= DMXNOW_MAX_PAYLOAD) {
+                    memcpy(scratch, slots, header.length);
+                    decoded = dmxNowDecodeDelta(payload, size, scratch, header.length);
+                }
+            } else if (header.length <= DMXNOW_MAX_PAYLOAD) {
+                decoded = dmxNowDecodeRLE(payload, size, scratch, header.length);
+            }
+            if (!decoded) {
+                decodeErrors++;
+                return FRAGMENT_REJECTED;
+            }
+            memcpy(slots, scratch, header.length);
+        } else {
+            memcpy(slots, payload, header.length);
+        }
+        received |= bit;
+        if (header.fragment == 0) frameStart = header.start;
+
+        allFragments = (uint8_t)((1 << header.fragmentCount) - 1);
+        if (received == allFragments) {
+            complete = true;
+            framesComplete++;
+            return FRAME_COMPLETE;
+        }
+        return (superseded && applyPartial) ? FRAME_PARTIAL : FRAGMENT_STORED;
+    }
+
+    /**
+     * @brief Give up on an incomplete frame older than timeoutMs
+     *
+     * @return true if the caller should apply a partial frame
+     */
+    bool expire(uint32_t nowMs) {
+        if (!active || complete || nowMs - startedMs < timeoutMs) return false;
+        complete = true; // late fragments of this frame are rejected
+        timeouts++;
+        return applyPartial;
+    }
+
+    /**
+     * @brief Forget the current frame and the slots, e.g. when switching universe
+     *
+     * The next fragment starts a new frame that has no base for deltas,
+     * counters are kept.
+     */
+    void reset() {
+        memset(buffer, 0, sizeof(buffer));
+        sequence = 0;
+        frameStart = 1;
+        received = 0;
+        allFragments = 0;
+        hasBase = false;
+        active = false;
+        complete = false;
+    }
+
+    const uint8_t* slots() const { return buffer; }  ///< Slot 1 at index 0
+    uint16_t getFrameStart() const { return frameStart; } ///< First slot of fragment 0
+    uint16_t getSequence() const { return sequence; }
+
+private:
+    uint8_t buffer[DMXNOW_UNIVERSE_SLOTS] = {};
+    uint16_t sequence = 0;
+    uint16_t frameStart = 1;
+    uint8_t received = 0;    ///< Bit per fragment seen
+    uint8_t allFragments = 0; ///< received once the frame is complete
+    bool hasBase = false;    ///< Previous frame complete, deltas of this frame apply
+    bool active = false;
+    bool complete = false;
+    uint32_t startedMs = 0;
+};
+
+#endif // DMXNOWPACKET_H
@@ -11,8 +11,13 @@
 
 #include "ESP32S3DMX.h"
 
-// Static instance pointer for callbacks
-ESP32S3DMX* ESP32S3DMX::instance = nullptr;
+// Upper bounds of the jitter histogram buckets in microseconds
+static const uint32_t jitterBucketLimitUs[DMX_JITTER_BUCKETS - 1] = {
+    50, 100, 250, 500, 1000, 2500, 5000
+};
+
+// Instance bound to each UART, guards against two receivers on one peripheral
+ESP32S3DMX* ESP32S3DMX::uartOwner[DMX_UART_COUNT] = {nullptr};
 
 ESP32S3DMX::ESP32S3DMX() :
     dmxSerial(nullptr),
@@ -20,19 +25,32 @@ ESP32S3DMX::ESP32S3DMX() :
     rxPin(-1),
     txPin(-1),
     enablePin(-1),
+    frameSequence(0),
     inPacket(false),
     bufferIndex(0),
-    lastPacketSize(0),
+    frameCallbacks(0),
+    lastFrameCallbacks(0),
+    callbackCount(0),
+    rxFIFOFull(DMX_RX_FIFO_FULL_DEFAULT),
+    rxTimeout(DMX_RX_TIMEOUT_DEFAULT),
     lastPacketTime(0),
+    lastFrameTime(0),
+    frameCallback(nullptr),
+    frameNotifyTask(nullptr),
     packetCount(0),
     errorCount(0),
-    lastPacketRateTime(0),
-    lastPacketCountForRate(0),
+    statsSequence(0),
+    intervalEwmaUs(0),
+    statsResetRequested(false),
+    lastBreakTime(0),
+    breakErrorExpected(false),
     debugMode(false),
     initialized(false)
 {
     // Clear buffers
-    memset((void*)dmxData, 0, DMX_PACKET_SIZE);
+    memset(frames, 0, sizeof(frames));
+    memset(frameSize, 0, sizeof(frameSize));
+    memset(&stats, 0, sizeof(stats));
     memset((void*)dmxBuffer, 0, DMX_BUFFER_SIZE);
 }
 
@@ -40,20 +58,21 @@ ESP32S3DMX::~ESP32S3DMX() {
     end();
 }
 
-void ESP32S3DMX::begin(uint8_t uart_num, int rx_pin, int tx_pin, int enable_pin) {
+bool ESP32S3DMX::begin(uint8_t uart_num, int rx_pin, int tx_pin, int enable_pin) {
     if (initialized) {
         end();
     }
     
+    if (uart_num >= DMX_UART_COUNT || uartOwner[uart_num] != nullptr) {
+        return false;
+    }
+    
     // Store configuration
     uartNum = uart_num;
     rxPin = rx_pin;
     txPin = tx_pin;
     enablePin = enable_pin;
     
-    // Set instance pointer for callbacks
-    instance = this;
-    
     // Configure RS485 direction pin (receive mode)
     if (enablePin >= 0) {
         pinMode(enablePin, OUTPUT);
@@ -64,30 +83,34 @@ void ESP32S3DMX::begin(uint8_t uart_num, int rx_pin, int tx_pin, int enable_pin)
     dmxSerial = new HardwareSerial(uartNum);
     
     if (!dmxSerial) {
-        return;
+        return false;
     }
     
-    // Configure and start UART
-    dmxSerial->begin(DMX_BAUDRATE, DMX_SERIAL_CONFIG, rxPin, txPin);
+    // Claim the UART for this instance
+    uartOwner[uartNum] = this;
+    
+    // Configure and start UART (buffer size must be set before begin)
     dmxSerial->setRxBufferSize(DMX_BUFFER_SIZE);
+    dmxSerial->begin(DMX_BAUDRATE, DMX_SERIAL_CONFIG, rxPin, txPin,
+                     false, 20000UL, rxFIFOFull);
+    dmxSerial->setRxTimeout(rxTimeout);
     
-    // Set up error callback for break detection
-    dmxSerial->onReceiveError([](hardwareSerial_error_t error) {
-        if (instance && error == UART_BREAK_ERROR) {
-            instance->processBreak();
+    // Set up error callback for break detection, dispatched to this instance
+    dmxSerial->onReceiveError([this](hardwareSerial_error_t error) {
+        if (error == UART_BREAK_ERROR) {
+            processBreak();
+        } else {
+            processError(error);
         }
     });
     
-    // Set up data received callback
-    dmxSerial->onReceive([]() {
-        if (instance) {
-            instance->processData();
-        }
+    // Set up data received callback, dispatched to this instance
+    dmxSerial->onReceive([this]() {
+        processData();
     });
     
     // Initialize timing
     lastPacketTime = millis();
-    lastPacketRateTime = millis();
     
     // Clear UART buffer before starting
     delay(10);
@@ -96,6 +119,7 @@ void ESP32S3DMX::begin(uint8_t uart_num, int rx_pin, int tx_pin, int enable_pin)
     }
     
     initialized = true;
+    return true;
 }
 
 void ESP32S3DMX::end() {
@@ -110,10 +134,48 @@ void ESP32S3DMX::end() {
     }
     
     initialized = false;
-    instance = nullptr;
+    uartOwner[uartNum] = nullptr;
+}
+
+bool ESP32S3DMX::setRxFIFOFull(uint8_t threshold) {
+    if (threshold == 0 || threshold >= 128) {
+        return false;
+    }
+    
+    rxFIFOFull = threshold;
+    if (initialized && dmxSerial) {
+        return dmxSerial->setRxFIFOFull(threshold);
+    }
+    return true;
+}
+
+bool ESP32S3DMX::setRxTimeout(uint8_t symbols) {
+    if (symbols == 0 || symbols > 92) {
+        return false;
+    }
+    
+    rxTimeout = symbols;
+    if (initialized && dmxSerial) {
+        return dmxSerial->setRxTimeout(symbols);
+    }
+    return true;
 }
 
 void ESP32S3DMX::processBreak() {
+    int64_t now = esp_timer_get_time();
+    
+    statsBeginWrite();
+    if (statsResetRequested) {
+        memset(&stats, 0, sizeof(stats));
+        statsResetRequested = false;
+    }
+    if (lastBreakTime != 0 && now - lastBreakTime < DMX_MIN_PACKET_US) {
+        stats.shortBreakIntervals++;
+    }
+    statsEndWrite();
+    lastBreakTime = now;
+    breakErrorExpected = true;
+    
     // Break detected - process previous packet if we have data
     if (bufferIndex > 0) {
         // ESP32S3 UART typically captures 1 extra byte at the start of break
@@ -126,17 +188,97 @@ void ESP32S3DMX::processBreak() {
         uint16_t copySize = (dmxDataSize > DMX_PACKET_SIZE) ? DMX_PACKET_SIZE : dmxDataSize;
         
         if (copySize > 0) {
-            noInterrupts();
-            memcpy((void*)dmxData, (void*)&dmxBuffer[dataStart], copySize);
-            lastPacketSize = copySize;
+            // Fill the slot after the published one; readers of the current
+            // frame are untouched. Publishing is a single release store.
+            uint32_t seq = frameSequence.load(std::memory_order_relaxed) + 1;
+            uint8_t slot = seq % DMX_FRAME_SLOTS;
+            memcpy(frames[slot], (const void*)&dmxBuffer[dataStart], copySize);
+            frameSize[slot] = copySize;
+            updateFrameStats(now, copySize, frames[slot][0]);
+            lastFrameTime = now;
+            frameSequence.store(seq, std::memory_order_release);
             lastPacketTime = millis();
             packetCount++;
-            interrupts();
+            
+            if (frameNotifyTask) {
+                xTaskNotifyGive(frameNotifyTask);
+            }
+            if (frameCallback) {
+                frameCallback(seq, copySize, now);
+            }
         }
     }
     
     // Reset buffer for next packet
     bufferIndex = 0;
+    lastFrameCallbacks = frameCallbacks;
+    frameCallbacks = 0;
+}
+
+// The UART raises a frame error for every break, reported right after the
+// break event and before the break's artifact byte is read. That one is
+// not a line error and is not counted.
+void ESP32S3DMX::processError(hardwareSerial_error_t error) {
+    if (error == UART_FRAME_ERROR && breakErrorExpected) {
+        breakErrorExpected = false;
+        return;
+    }
+    statsBeginWrite();
+    switch (error) {
+        case UART_FRAME_ERROR:
+        case UART_PARITY_ERROR:
+            stats.framingErrors++;
+            break;
+        case UART_FIFO_OVF_ERROR:
+        case UART_BUFFER_FULL_ERROR:
+            stats.overruns++;
+            break;
+        default:
+            break;
+    }
+    statsEndWrite();
+    errorCount++;
+}
+
+void ESP32S3DMX::updateFrameStats(int64_t now, uint16_t size, uint8_t startCode) {
+    statsBeginWrite();
+    
+    if (startCode != 0) {
+        stats.nonZeroStartCodes++;
+    }
+    
+    uint16_t slots = size - 1;  // size includes the start code
+    uint8_t slotBucket = (slots == 0) ? 0 : (slots - 1) / (DMX_CHANNELS / DMX_SLOT_BUCKETS);
+    stats.slotHistogram[slotBucket]++;
+    
+    int64_t elapsed = now - lastFrameTime;
+    if (lastFrameTime != 0 && elapsed < (int64_t)DMX_TIMEOUT_MS * 1000) {
+        uint32_t interval = (uint32_t)elapsed;
+        uint32_t avg = intervalEwmaUs.load(std::memory_order_relaxed);
+        
+        if (stats.frames == 0 || avg == 0) {
+            stats.intervalMinUs = interval;
+            stats.intervalMaxUs = interval;
+            avg = interval;
+        } else {
+            if (interval < stats.intervalMinUs) stats.intervalMinUs = interval;
+            if (interval > stats.intervalMaxUs) stats.intervalMaxUs = interval;
+            avg = avg + ((int32_t)(interval - avg) >> DMX_RATE_EWMA_SHIFT);
+        }
+        
+        uint32_t jitter = (interval > avg) ? interval - avg : avg - interval;
+        uint8_t bucket = 0;
+        while (bucket < DMX_JITTER_BUCKETS - 1 && jitter >= jitterBucketLimitUs[bucket]) {
+            bucket++;
+        }
+        stats.jitterHistogram[bucket]++;
+        
+        stats.intervalAvgUs = avg;
+        stats.frames++;
+        intervalEwmaUs.store(avg, std::memory_order_relaxed);
+    }
+    
+    statsEndWrite();
 }
 
 void ESP32S3DMX::processData() {
@@ -144,9 +286,32 @@ void ESP32S3DMX::processData() {
         return;
     }
     
-    // Read all available data
-    while (dmxSerial->available() && bufferIndex < DMX_BUFFER_SIZE) {
-        dmxBuffer[bufferIndex++] = dmxSerial->read();
+    frameCallbacks++;
+    callbackCount++;
+    breakErrorExpected = false;
+    
+    // Read all available data in as few chunks as possible
+    int available = dmxSerial->available();
+    while (available > 0) {
+        uint16_t space = DMX_BUFFER_SIZE - bufferIndex;
+        size_t got;
+        if (space == 0) {
+            // Frame longer than a DMX packet - drop the excess so it does
+            // not leak into the start of the next frame
+            uint8_t discard[32];
+            got = dmxSerial->read(discard, min((size_t)available, sizeof(discard)));
+            statsBeginWrite();
+            stats.overruns++;
+            statsEndWrite();
+        } else {
+            size_t chunk = min((size_t)available, (size_t)space);
+            got = dmxSerial->read((uint8_t*)&dmxBuffer[bufferIndex], chunk);
+            bufferIndex += got;
+        }
+        if (got == 0) {
+            break;
+        }
+        available = dmxSerial->available();
     }
 }
 
@@ -160,12 +325,22 @@ uint8_t ESP32S3DMX::read(uint16_t channel) {
         return 0;
     }
     
-    // Bounds check against actual packet size
-    if (channel >= lastPacketSize) {
-        return 0;
-    }
+    uint32_t seq;
+    uint8_t value;
+    do {
+        seq = getFrameSequence();
+        uint8_t slot = seq % DMX_FRAME_SLOTS;
+        
+        // Bounds check against actual packet size
+        if (channel >= frameSize[slot]) {
+            return 0;
+        }
+        
+        value = frames[slot][channel];  // frames[][0] is start code, frames[][1] is channel 1
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while (seq != 0 && !isFrameValid(seq));
     
-    return dmxData[channel];  // dmxData[0] is start code, dmxData[1] is channel 1
+    return value;
 }
 
 uint16_t ESP32S3DMX::readChannels(uint8_t* buffer, uint16_t start_channel, uint16_t count) {
@@ -178,22 +353,59 @@ uint16_t ESP32S3DMX::readChannels(uint8_t* buffer, uint16_t start_channel, uint1
         return 0;
     }
     
-    // Calculate how many channels we can actually read
-    uint16_t available = 0;
-    if (lastPacketSize > start_channel) {
-        available = lastPacketSize - start_channel;
-    } else {
+    uint32_t seq;
+    uint16_t toRead;
+    do {
+        seq = getFrameSequence();
+        uint8_t slot = seq % DMX_FRAME_SLOTS;
+        
+        // Calculate how many channels we can actually read
+        uint16_t size = frameSize[slot];
+        if (size <= start_channel) {
+            return 0;
+        }
+        uint16_t available = size - start_channel;
+        toRead = (count < available) ? count : available;
+        
+        memcpy(buffer, &frames[slot][start_channel], toRead);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while (seq != 0 && !isFrameValid(seq));  // writer lapped us, copy again
+    
+    return toRead;
+}
+
+uint32_t ESP32S3DMX::readFrame(uint8_t* buffer, uint16_t* size) const {
+    if (!buffer) {
         return 0;
     }
     
-    uint16_t toRead = (count < available) ? count : available;
+    uint32_t seq;
+    uint16_t frameBytes;
+    do {
+        seq = getFrameSequence();
+        uint8_t slot = seq % DMX_FRAME_SLOTS;
+        frameBytes = frameSize[slot];
+        memcpy(buffer, frames[slot], DMX_PACKET_SIZE);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while (seq != 0 && !isFrameValid(seq));
     
-    // Copy data
-    noInterrupts();
-    memcpy(buffer, (void*)&dmxData[start_channel], toRead);
-    interrupts();
+    if (size) {
+        *size = frameBytes;
+    }
+    return seq;
+}
+
+const uint8_t* ESP32S3DMX::getFrame(uint32_t* sequence, uint16_t* size) const {
+    uint32_t seq = getFrameSequence();
+    uint8_t slot = seq % DMX_FRAME_SLOTS;
     
-    return toRead;
+    if (sequence) {
+        *sequence = seq;
+    }
+    if (size) {
+        *size = frameSize[slot];
+    }
+    return frames[slot];
 }
 
 bool ESP32S3DMX::isConnected() const {
@@ -214,32 +426,24 @@ uint32_t ESP32S3DMX::timeSinceLastPacket() const {
 }
 
 float ESP32S3DMX::getPacketRate() const {
-    if (!initialized || packetCount == 0) {
+    if (!initialized || !isConnected()) {
         return 0.0;
     }
     
-    uint32_t now = millis();
-    uint32_t timeDiff = now - lastPacketRateTime;
+    uint32_t avg = intervalEwmaUs.load(std::memory_order_relaxed);
+    if (avg == 0) {
+        return 0.0;
+    }
+    return 1000000.0f / avg;
+}
+
+void ESP32S3DMX::getStats(DMXStats& out) const {
+    uint32_t seq;
+    do {
+        seq = statsSequence.load(std::memory_order_acquire);
+        memcpy(&out, &stats, sizeof(DMXStats));
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || seq != statsSequence.load(std::memory_order_relaxed));
     
-    if (timeDiff >= 1000) {  // Update rate every second
-        // Calculate rate based on packets received in the last period
-        uint32_t packetDiff = packetCount - lastPacketCountForRate;
-        float rate = (packetDiff * 1000.0f) / timeDiff;
-        
-        // Update for next calculation
-        const_cast<ESP32S3DMX*>(this)->lastPacketRateTime = now;
-        const_cast<ESP32S3DMX*>(this)->lastPacketCountForRate = packetCount;
-        
-        return rate;
-    } else if (lastPacketCountForRate == 0) {
-        // First calculation
-        float rate = (packetCount * 1000.0f) / (now - 0);
-        const_cast<ESP32S3DMX*>(this)->lastPacketRateTime = now;
-        const_cast<ESP32S3DMX*>(this)->lastPacketCountForRate = packetCount;
-        return rate;
-    }
-    
-    // Return last calculated rate
-    uint32_t packetDiff = packetCount - lastPacketCountForRate;
-    return (packetDiff * 1000.0f) / timeDiff;
-}
\ No newline at end of file
+    out.packetRate = getPacketRate();
+}
@@ -1,7 +1,7 @@
 /**
  * @file ESP32S3DMX.h
  * @brief DMX512 receiver library for ESP32 with Arduino Core 3.0+
- * @version 1.0.0
+ * @version 1.1.0
  * @date 2024
  * 
  * @copyright Copyright (c) 2024. Licensed under LGPL v2.1
@@ -19,6 +19,9 @@
 
 #include <Arduino.h>
 #include <HardwareSerial.h>
+#include <esp_timer.h>
+#include <atomic>
+#include <functional>
 
 // DMX Protocol Constants
 #define DMX_BAUDRATE 250000          ///< DMX512 baud rate (250kbps)
@@ -26,17 +29,64 @@
 #define DMX_CHANNELS 512             ///< Maximum DMX channels per universe
 #define DMX_PACKET_SIZE 513          ///< Start code + 512 channels
 #define DMX_BUFFER_SIZE 514          ///< Extra byte for UART break artifact
+#define DMX_FRAME_SLOTS 3            ///< Published frame buffers (triple buffering)
 
 // DMX Timing Constants
 #define DMX_BREAK_MIN 88       ///< Minimum break time in microseconds
 #define DMX_MAB_MIN 8          ///< Minimum mark after break in microseconds
 #define DMX_TIMEOUT_MS 1000    ///< Connection timeout in milliseconds
+#define DMX_MIN_PACKET_US (DMX_BREAK_MIN + DMX_MAB_MIN + 44) ///< Shortest legal break-to-break time
+
+// Statistics
+#define DMX_JITTER_BUCKETS 8   ///< Jitter histogram buckets (see DMXStats::jitterHistogram)
+#define DMX_SLOT_BUCKETS 8     ///< Slot-count histogram buckets of 64 channels each
+#define DMX_RATE_EWMA_SHIFT 4  ///< Interval EWMA weight 1/16
+
+// UART Receive Tuning
+#define DMX_RX_FIFO_FULL_DEFAULT 120 ///< Bytes in the 128-byte RX FIFO before a receive callback
+#define DMX_RX_TIMEOUT_DEFAULT 2     ///< Idle symbols (44us each) before a partial FIFO is delivered
 
 // Default Pin Configuration
 #define DEFAULT_RX_PIN 6       ///< Default GPIO for UART RX
 #define DEFAULT_TX_PIN 4       ///< Default GPIO for UART TX
 #define DEFAULT_ENABLE_PIN 5   ///< Default GPIO for RS485 direction control
 
+#ifdef SOC_UART_NUM
+#define DMX_UART_COUNT SOC_UART_NUM ///< UART peripherals on this chip
+#else
+#define DMX_UART_COUNT 3       ///< UART peripherals on the ESP32-S3 (UART0-2)
+#endif
+
+/**
+ * @brief DMX input timing and error statistics
+ * 
+ * Intervals are measured between consecutive published frames with
+ * esp_timer. Gaps longer than DMX_TIMEOUT_MS are treated as signal loss
+ * and not counted as intervals.
+ */
+struct DMXStats {
+    uint32_t frames;              ///< Frames included in the interval statistics
+    uint32_t intervalMinUs;       ///< Shortest frame-to-frame interval
+    uint32_t intervalAvgUs;       ///< EWMA frame-to-frame interval
+    uint32_t intervalMaxUs;       ///< Longest frame-to-frame interval
+    uint32_t jitterHistogram[DMX_JITTER_BUCKETS]; ///< |interval - avg|: <50, <100, <250, <500, <1000, <2500, <5000, >=5000 us
+    uint32_t slotHistogram[DMX_SLOT_BUCKETS];     ///< Channels per frame: 0-64, 65-128, ..., 449-512
+    uint32_t shortBreakIntervals; ///< Break-to-break intervals below DMX_MIN_PACKET_US (not a measured break length)
+    uint32_t framingErrors;       ///< UART framing/parity errors, not counting the one each break raises
+    uint32_t overruns;            ///< UART FIFO/buffer overflows and over-length frames
+    uint32_t nonZeroStartCodes;   ///< Frames with an alternate start code (RDM, text, ...)
+    float packetRate;             ///< Packets per second from the interval EWMA
+};
+
+/**
+ * @brief Frame-complete callback
+ * 
+ * @param sequence Sequence number of the completed frame
+ * @param size Number of bytes in the frame (start code + channels)
+ * @param timestamp_us esp_timer time at which the frame was published
+ */
+typedef std::function<void(uint32_t sequence, uint16_t size, int64_t timestamp_us)> DMXFrameCallback;
+
 /**
  * @class ESP32S3DMX
  * @brief DMX512 receiver implementation for ESP32
@@ -45,7 +95,13 @@
  * compatible with Arduino Core 3.0+. It uses hardware UART with break
  * detection to receive DMX data efficiently.
  * 
- * @note Only one instance should be created per UART peripheral
+ * @note Several instances can run concurrently, one per UART peripheral.
+ *       begin() fails if the UART is already used by another instance.
+ * 
+ * Completed frames are published into a triple-buffered frame store guarded
+ * by a sequence counter (seqlock). The receive callback never waits for
+ * readers and readers never mask interrupts: a reader that overlaps with
+ * two newer frames simply retries its copy.
  * 
  * Example usage:
  * @code
@@ -62,6 +118,17 @@
  *     }
  * }
  * @endcode
+ * 
+ * Two universes on UART1 and UART2:
+ * @code
+ * ESP32S3DMX universeA;
+ * ESP32S3DMXPort<1, 16, 17, 18> universeB;  // UART/pins fixed at compile time
+ * 
+ * void setup() {
+ *     universeA.begin(2, 6, 4, 5);
+ *     universeB.begin();
+ * }
+ * @endcode
  */
 class ESP32S3DMX {
 public:
@@ -83,9 +150,12 @@ public:
      * @param tx_pin GPIO pin connected to RS485 DI (transmit) - not used for receive
      * @param enable_pin GPIO pin connected to RS485 DE/RE (direction control)
      * 
+     * @return true if the receiver was started
+     * @return false if the UART number is invalid, already in use or could not be allocated
+     * 
      * @note UART0 is not supported on ESP32-S3 when USB CDC is enabled
      */
-    void begin(uint8_t uart_num = 2, 
+    bool begin(uint8_t uart_num = 2, 
                int rx_pin = DEFAULT_RX_PIN, 
                int tx_pin = DEFAULT_TX_PIN, 
                int enable_pin = DEFAULT_ENABLE_PIN);
@@ -95,6 +165,54 @@ public:
      */
     void end();
     
+    /**
+     * @brief Set the RX FIFO fill level that triggers a receive callback
+     * 
+     * Higher values mean fewer callbacks per frame, but less headroom before
+     * the 128-byte hardware FIFO overflows.
+     * 
+     * @param threshold Bytes (1-127), default DMX_RX_FIFO_FULL_DEFAULT
+     * @return true if the setting was accepted
+     * 
+     * @note Takes effect immediately if already running, otherwise at begin()
+     */
+    bool setRxFIFOFull(uint8_t threshold);
+    
+    /**
+     * @brief Set the idle time after which a partially filled FIFO is delivered
+     * 
+     * @param symbols Idle time in UART symbols (1-92), default DMX_RX_TIMEOUT_DEFAULT
+     * @return true if the setting was accepted
+     * 
+     * @note Takes effect immediately if already running, otherwise at begin()
+     */
+    bool setRxTimeout(uint8_t symbols);
+    
+    /**
+     * @brief Register a callback fired for every completed frame
+     * 
+     * @param callback Function to call, or nullptr to remove
+     * 
+     * @warning Runs in the UART event task. Keep it short and do not block.
+     */
+    void onFrame(DMXFrameCallback callback) { frameCallback = callback; }
+    
+    /**
+     * @brief Send a FreeRTOS task notification for every completed frame
+     * 
+     * The task can block in ulTaskNotifyTake() until the next frame arrives.
+     * 
+     * @param task Task to notify, or nullptr to stop notifying
+     */
+    void notifyOnFrame(TaskHandle_t task) { frameNotifyTask = task; }
+    
+    /**
+     * @brief Get the time at which the latest frame was published
+     * 
+     * @return int64_t esp_timer_get_time() timestamp in microseconds, 0 if none received
+     */
+    int64_t getLastFrameTime() const { return lastFrameTime; }
+    
     /**
      * @brief Read a single DMX channel value
      * 
@@ -111,17 +229,56 @@ public:
      * @param count Number of channels to read
      * @return uint16_t Number of channels actually read
      * 
-     * @note This method is more efficient than multiple read() calls
+     * @note This method is more efficient than multiple read() calls.
+     *       All channels are taken from the same frame.
      */
     uint16_t readChannels(uint8_t* buffer, uint16_t start_channel, uint16_t count);
     
     /**
-     * @brief Get direct access to the DMX data buffer
+     * @brief Copy a consistent snapshot of the latest complete frame
+     * 
+     * @param buffer Array of at least DMX_PACKET_SIZE bytes (start code + 512 channels)
+     * @param size Receives the number of valid bytes in the frame (may be nullptr)
+     * @return uint32_t Sequence number of the copied frame, 0 if no frame received yet
+     */
+    uint32_t readFrame(uint8_t* buffer, uint16_t* size = nullptr) const;
+    
+    /**
+     * @brief Get a zero-copy view of the latest complete frame
+     * 
+     * @param sequence Receives the sequence number of the frame (may be nullptr)
+     * @param size Receives the number of valid bytes in the frame (may be nullptr)
+     * @return const uint8_t* Pointer to the 513-byte frame (start code + 512 channels)
+     * 
+     * @note The view stays intact until two newer frames have completed.
+     *       Call isFrameValid() after using the data to confirm it was not overwritten.
+     */
+    const uint8_t* getFrame(uint32_t* sequence = nullptr, uint16_t* size = nullptr) const;
+    
+    /**
+     * @brief Check whether a frame obtained with getFrame() is still intact
+     * 
+     * @param sequence Sequence number returned by getFrame()
+     * @return true if the frame buffer has not been reused yet
+     */
+    bool isFrameValid(uint32_t sequence) const {
+        return sequence != 0 && (getFrameSequence() - sequence) < (DMX_FRAME_SLOTS - 1);
+    }
+    
+    /**
+     * @brief Get the sequence number of the latest complete frame
+     * 
+     * @return uint32_t Increments by one per received frame, 0 if none received yet
+     */
+    uint32_t getFrameSequence() const { return frameSequence.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief Get direct access to the latest complete frame
      * 
      * @return const uint8_t* Pointer to 513-byte buffer (start code + 512 channels)
-     * @warning The buffer contents may change during access. Use with caution.
+     * @warning The buffer is reused after two newer frames. Prefer getFrame() or readFrame().
      */
-    const uint8_t* getBuffer() const { return (const uint8_t*)dmxData; }
+    const uint8_t* getBuffer() const { return getFrame(); }
     
     /**
      * @brief Check if receiving valid DMX signal
@@ -155,16 +312,50 @@ public:
     /**
      * @brief Get current packet reception rate
      * 
-     * @return float Packets per second (typically 44-50 Hz for DMX)
+     * @return float Packets per second (typically 44-50 Hz for DMX), 0 if no signal
+     * 
+     * @note Derived from an EWMA of the frame interval, does not modify state
      */
     float getPacketRate() const;
     
+    /**
+     * @brief Copy a consistent snapshot of the timing and error statistics
+     * 
+     * @param out Receives the statistics
+     * 
+     * @note Lock-free: never blocks the receive callback, retries if a frame
+     *       completes during the copy
+     */
+    void getStats(DMXStats& out) const;
+    
+    /**
+     * @brief Clear the statistics
+     * 
+     * The reset is carried out by the receive callback at the next break, so
+     * the statistics keep a single writer.
+     */
+    void resetStats() { statsResetRequested = true; }
+    
     /**
      * @brief Get size of last received packet
      * 
      * @return uint16_t Packet size in bytes (1-513)
      */
-    uint16_t getLastPacketSize() const { return lastPacketSize; }
+    uint16_t getLastPacketSize() const { return frameSize[getFrameSequence() % DMX_FRAME_SLOTS]; }
+    
+    /**
+     * @brief Get number of receive callbacks taken for the last complete frame
+     * 
+     * @return uint16_t Callbacks between the last two breaks
+     */
+    uint16_t getCallbacksPerFrame() const { return lastFrameCallbacks; }
+    
+    /**
+     * @brief Get total number of receive callbacks
+     * 
+     * @return uint32_t Callback count since initialization
+     */
+    uint32_t getCallbackCount() const { return callbackCount; }
     
 private:
     HardwareSerial* dmxSerial;               ///< UART instance
@@ -173,22 +364,36 @@ private:
     int txPin;                               ///< TX pin number
     int enablePin;                           ///< RS485 direction control pin
     
-    volatile uint8_t dmxData[DMX_PACKET_SIZE];    ///< DMX data buffer
+    uint8_t frames[DMX_FRAME_SLOTS][DMX_PACKET_SIZE]; ///< Published frames, slot = sequence % DMX_FRAME_SLOTS
+    uint16_t frameSize[DMX_FRAME_SLOTS];     ///< Valid bytes per published frame
+    std::atomic<uint32_t> frameSequence;     ///< Sequence number of the latest published frame
     volatile uint8_t dmxBuffer[DMX_BUFFER_SIZE];  ///< UART receive buffer
     
     volatile bool inPacket;                  ///< Currently receiving packet flag
     volatile uint16_t bufferIndex;           ///< Current buffer position
-    volatile uint16_t lastPacketSize;        ///< Size of last complete packet
+    volatile uint16_t frameCallbacks;        ///< Receive callbacks in the current frame
+    volatile uint16_t lastFrameCallbacks;    ///< Receive callbacks in the last complete frame
+    volatile uint32_t callbackCount;         ///< Total receive callbacks
+    uint8_t rxFIFOFull;                      ///< RX FIFO full threshold in bytes
+    uint8_t rxTimeout;                       ///< RX timeout in symbols
     volatile uint32_t lastPacketTime;        ///< Timestamp of last packet
+    volatile int64_t lastFrameTime;          ///< Microsecond timestamp of last published frame
+    DMXFrameCallback frameCallback;          ///< Frame-complete callback
+    TaskHandle_t frameNotifyTask;            ///< Task notified on frame completion
     volatile uint32_t packetCount;           ///< Total packets received
     volatile uint32_t errorCount;            ///< Total errors detected
-    uint32_t lastPacketRateTime;            ///< Last rate calculation time
-    uint32_t lastPacketCountForRate;        ///< Packet count at last rate calc
+    
+    DMXStats stats;                          ///< Statistics, written by the UART callbacks only
+    std::atomic<uint32_t> statsSequence;     ///< Odd while stats is being updated
+    std::atomic<uint32_t> intervalEwmaUs;    ///< Frame interval EWMA for getPacketRate()
+    volatile bool statsResetRequested;       ///< Clear stats at the next break
+    int64_t lastBreakTime;                   ///< esp_timer time of the previous break
+    bool breakErrorExpected;                 ///< Break seen, its frame error not yet and no data read since
     
     bool debugMode;                          ///< Debug output enable flag
     bool initialized;                        ///< Initialization status
     
-    static ESP32S3DMX* instance;             ///< Singleton instance for callbacks
+    static ESP32S3DMX* uartOwner[DMX_UART_COUNT]; ///< Instance bound to each UART
     
     /**
      * @brief Process UART break detection
@@ -196,11 +401,62 @@ private:
      */
     void processBreak();
     
+    /**
+     * @brief Process a UART receive error
+     * @private
+     */
+    void processError(hardwareSerial_error_t error);
+    
+    /**
+     * @brief Update interval and slot statistics for a published frame
+     * @private
+     */
+    void updateFrameStats(int64_t now, uint16_t size, uint8_t startCode);
+    
+    /**
+     * @brief Mark the statistics as being written (seqlock)
+     * @private
+     */
+    void statsBeginWrite() {
+        statsSequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    
+    /**
+     * @brief Mark the statistics as consistent again (seqlock)
+     * @private
+     */
+    void statsEndWrite() { statsSequence.fetch_add(1, std::memory_order_release); }
+    
     /**
      * @brief Process received UART data
+     * 
+     * Drains the UART in bulk reads straight into dmxBuffer.
      * @private
      */
     void processData();
 };
 
+/**
+ * @class ESP32S3DMXPort
+ * @brief ESP32S3DMX with UART and pins selected at compile time
+ * 
+ * @tparam UART UART peripheral (1 or 2)
+ * @tparam RX_PIN GPIO pin connected to RS485 RO
+ * @tparam TX_PIN GPIO pin connected to RS485 DI
+ * @tparam ENABLE_PIN GPIO pin connected to RS485 DE/RE, -1 if not used
+ */
+template <uint8_t UART, int RX_PIN, int TX_PIN = -1, int ENABLE_PIN = -1>
+class ESP32S3DMXPort : public ESP32S3DMX {
+    static_assert(UART >= 1 && UART < DMX_UART_COUNT, "ESP32S3DMXPort: UART must be 1 or 2");
+    
+public:
+    /**
+     * @brief Initialize the DMX receiver on the compile-time UART and pins
+     * 
+     * @return true if the receiver was started
+     */
+    bool begin() { return ESP32S3DMX::begin(UART, RX_PIN, TX_PIN, ENABLE_PIN); }
+};
+
 #endif // ESP32S3DMX_H
\ No newline at end of file
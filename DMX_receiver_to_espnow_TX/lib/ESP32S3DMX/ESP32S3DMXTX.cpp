@@ -0,0 +1,135 @@
+/*
+  ESP32S3DMXTX.cpp - DMX512 transmitter for ESP32 with Arduino Core 3.0+
+  
+  Copyright (c) 2024
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "ESP32S3DMXTX.h"
+#include <driver/uart.h>
+
+ESP32S3DMXTX::ESP32S3DMXTX() :
+    dmxSerial(nullptr),
+    uartNum(0),
+    txPin(-1),
+    enablePin(-1),
+    breakBits(DMX_TX_BREAK_US / DMX_BIT_US),
+    mabBits(DMX_TX_MAB_US / DMX_BIT_US),
+    frameCount(0),
+    busyCount(0),
+    initialized(false)
+{
+}
+
+ESP32S3DMXTX::~ESP32S3DMXTX() {
+    end();
+}
+
+bool ESP32S3DMXTX::begin(uint8_t uart_num, int tx_pin, int enable_pin) {
+    if (initialized) {
+        end();
+    }
+    
+    // Store configuration
+    uartNum = uart_num;
+    txPin = tx_pin;
+    enablePin = enable_pin;
+    
+    // Configure RS485 direction pin (transmit mode, driver always on)
+    if (enablePin >= 0) {
+        pinMode(enablePin, OUTPUT);
+        digitalWrite(enablePin, HIGH);
+    }
+    
+    dmxSerial = new HardwareSerial(uartNum);
+    
+    if (!dmxSerial) {
+        return false;
+    }
+    
+    // A TX ring buffer lets the driver send the frame in the background
+    // (buffer sizes must be set before begin)
+    dmxSerial->setTxBufferSize(DMX_TX_BUFFER_SIZE);
+    dmxSerial->begin(DMX_BAUDRATE, DMX_SERIAL_CONFIG, -1, txPin);
+    
+    // Idle time between the break and the next frame is the mark after break
+    uart_set_tx_idle_num((uart_port_t)uartNum, mabBits);
+    
+    initialized = true;
+    return true;
+}
+
+void ESP32S3DMXTX::end() {
+    if (!initialized) {
+        return;
+    }
+    
+    if (dmxSerial) {
+        dmxSerial->end();
+        delete dmxSerial;
+        dmxSerial = nullptr;
+    }
+    
+    if (enablePin >= 0) {
+        digitalWrite(enablePin, LOW);
+    }
+    
+    initialized = false;
+}
+
+bool ESP32S3DMXTX::write(const uint8_t* frame, uint16_t size) {
+    if (!initialized || !frame || size == 0 || size > DMX_PACKET_SIZE) {
+        return false;
+    }
+    
+    // One frame in flight at a time, the caller keeps its latest data
+    if (isBusy()) {
+        busyCount++;
+        return false;
+    }
+    
+    // Data first, then the break that starts the next frame
+    int written = uart_write_bytes_with_break((uart_port_t)uartNum, frame, size, breakBits);
+    if (written != size) {
+        return false;
+    }
+    
+    frameCount++;
+    return true;
+}
+
+bool ESP32S3DMXTX::isBusy() const {
+    if (!initialized) {
+        return false;
+    }
+    return uart_wait_tx_done((uart_port_t)uartNum, 0) != ESP_OK;
+}
+
+bool ESP32S3DMXTX::waitDone(uint32_t timeout_ms) const {
+    if (!initialized) {
+        return true;
+    }
+    return uart_wait_tx_done((uart_port_t)uartNum, pdMS_TO_TICKS(timeout_ms)) == ESP_OK;
+}
+
+void ESP32S3DMXTX::setBreakTime(uint16_t us) {
+    if (us < DMX_BREAK_MIN) {
+        us = DMX_BREAK_MIN;
+    }
+    uint16_t bits = (us + DMX_BIT_US - 1) / DMX_BIT_US;
+    breakBits = (bits > 255) ? 255 : bits;
+}
+
+void ESP32S3DMXTX::setMABTime(uint16_t us) {
+    if (us < DMX_MAB_MIN) {
+        us = DMX_MAB_MIN;
+    }
+    mabBits = (us + DMX_BIT_US - 1) / DMX_BIT_US;
+    if (initialized) {
+        uart_set_tx_idle_num((uart_port_t)uartNum, mabBits);
+    }
+}
@@ -0,0 +1,160 @@
+/**
+ * @file ESP32S3DMXTX.h
+ * @brief DMX512 transmitter for ESP32 with Arduino Core 3.0+
+ * @version 1.1.0
+ * @date 2024
+ * 
+ * @copyright Copyright (c) 2024. Licensed under LGPL v2.1
+ * 
+ * Transmit counterpart of ESP32S3DMX. The UART hardware generates the
+ * break and mark-after-break and the frame is sent from the UART TX ring
+ * buffer by the driver, so write() only copies the frame and returns.
+ */
+
+#ifndef ESP32S3DMXTX_H
+#define ESP32S3DMXTX_H
+
+#include <Arduino.h>
+#include <HardwareSerial.h>
+#include "ESP32S3DMX.h"
+
+// Transmit Timing Defaults
+#define DMX_TX_BREAK_US 120           ///< Break length in microseconds (min DMX_BREAK_MIN)
+#define DMX_TX_MAB_US 12              ///< Mark after break in microseconds (min DMX_MAB_MIN)
+#define DMX_TX_BUFFER_SIZE 1024       ///< UART TX ring buffer, holds a full frame
+#define DMX_BIT_US 4                  ///< One bit at 250 kbaud
+#define DMX_SLOT_US 44                ///< One 11-bit slot at 250 kbaud
+
+/**
+ * @class ESP32S3DMXTX
+ * @brief Non-blocking DMX512 transmitter
+ * 
+ * Each frame is handed to the UART driver together with a hardware break
+ * that follows the data, so the break in front of frame N+1 is already on
+ * the wire when frame N ends. The UART's TX idle time provides the
+ * mark-after-break before the next frame starts.
+ * 
+ * @note The first frame after begin() is not preceded by a break and is
+ *       ignored by receivers.
+ * 
+ * Example usage:
+ * @code
+ * ESP32S3DMXTX dmxTx;
+ * uint8_t frame[DMX_PACKET_SIZE];  // start code + 512 channels
+ * 
+ * void setup() {
+ *     dmxTx.begin(1, 10, 4);
+ * }
+ * 
+ * void loop() {
+ *     if (!dmxTx.isBusy()) {
+ *         dmxTx.write(frame, sizeof(frame));  // returns immediately
+ *     }
+ * }
+ * @endcode
+ */
+class ESP32S3DMXTX {
+public:
+    /**
+     * @brief Construct a new ESP32S3DMXTX object
+     */
+    ESP32S3DMXTX();
+    
+    /**
+     * @brief Destroy the ESP32S3DMXTX object and release resources
+     */
+    ~ESP32S3DMXTX();
+    
+    /**
+     * @brief Initialize the DMX transmitter
+     * 
+     * @param uart_num UART peripheral to use
+     * @param tx_pin GPIO pin connected to RS485 DI (transmit)
+     * @param enable_pin GPIO pin connected to RS485 DE (driven high), -1 if not used
+     * @return true if the transmitter was started
+     */
+    bool begin(uint8_t uart_num = 1, 
+               int tx_pin = DEFAULT_TX_PIN, 
+               int enable_pin = DEFAULT_ENABLE_PIN);
+    
+    /**
+     * @brief Stop the transmitter and release resources
+     */
+    void end();
+    
+    /**
+     * @brief Queue a frame for transmission
+     * 
+     * @param frame Start code followed by channel data
+     * @param size Bytes in frame (1-513)
+     * @return true if the frame was queued
+     * @return false if the previous frame is still being sent or the arguments are invalid
+     */
+    bool write(const uint8_t* frame, uint16_t size);
+    
+    /**
+     * @brief Check whether a frame is still being transmitted
+     * 
+     * @return true if data or the trailing break is still on the wire
+     */
+    bool isBusy() const;
+    
+    /**
+     * @brief Wait until the current frame and its break have been sent
+     * 
+     * @param timeout_ms Maximum time to wait
+     * @return true if the transmitter is idle
+     */
+    bool waitDone(uint32_t timeout_ms) const;
+    
+    /**
+     * @brief Set the break length
+     * 
+     * @param us Break in microseconds, at least DMX_BREAK_MIN
+     */
+    void setBreakTime(uint16_t us);
+    
+    /**
+     * @brief Set the mark after break
+     * 
+     * @param us Mark in microseconds, at least DMX_MAB_MIN
+     */
+    void setMABTime(uint16_t us);
+    
+    /**
+     * @brief Get the time one frame occupies on the wire
+     * 
+     * @param size Bytes in the frame (start code + channels)
+     * @return uint32_t Break + mark after break + slots, in microseconds
+     */
+    uint32_t getFrameTime(uint16_t size) const {
+        return (breakBits + mabBits) * DMX_BIT_US + (uint32_t)size * DMX_SLOT_US;
+    }
+    
+    /**
+     * @brief Get number of frames queued since initialization
+     * 
+     * @return uint32_t Frame count
+     */
+    uint32_t getFrameCount() const { return frameCount; }
+    
+    /**
+     * @brief Get number of write() calls rejected because the UART was busy
+     * 
+     * @return uint32_t Busy count
+     */
+    uint32_t getBusyCount() const { return busyCount; }
+    
+private:
+    HardwareSerial* dmxSerial;               ///< UART instance
+    uint8_t uartNum;                         ///< UART peripheral number
+    int txPin;                               ///< TX pin number
+    int enablePin;                           ///< RS485 driver enable pin
+    uint8_t breakBits;                       ///< Break length in bit times
+    uint16_t mabBits;                        ///< Mark after break in bit times
+    uint32_t frameCount;                     ///< Frames queued
+    uint32_t busyCount;                      ///< Writes rejected while busy
+    bool initialized;                        ///< Initialization status
+};
+
+#endif // ESP32S3DMXTX_H
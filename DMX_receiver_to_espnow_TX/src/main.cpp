@@ -5,6 +5,7 @@
 #include <ESPAsyncWebserver.h>
 #include <arduinojson.h>
 #include "ESP32S3DMX.h"
+#include "DMXNowPacket.h"
 #include <Adafruit_NeoPixel.h>
 
 
@@ -13,10 +14,27 @@
 #define DMX_RE_PIN 5
 #define DMX_CHANNELS 512
 
+// optional second universe on UART1 (second RS485 transceiver)
+#define DMX2_UART 1
+#define DMX2_RX_PIN 16
+#define DMX2_TX_PIN 17
+#define DMX2_EN_PIN 18
+#define DMX_UNIVERSES_MAX 2
+
 #define PIN_NEO_PIXEL 48
 #define NUM_LEDS 1
 
-uint8_t broadcastAddress[] = {0x32, 0xAE, 0xA4, 0x07, 0x0D, 0x66};
+#define FORWARD_INTERVAL_MS 10     // fastest the forwarded window is sampled, slowed down to the radio's pace
+#define MAX_FRAMES_IN_FLIGHT 2     // frames handed to ESP-NOW whose last packet hasn't left the radio
+#define SEND_TIMEOUT_MS 100        // give up on send callbacks of a frame after this long
+#define MAX_LINKS 16               // lights tracked in the link table
+#define LINK_STALE_MS 15000        // drop a light that stopped reporting for this long
+#define KEEPALIVE_DEFAULT_MS 1000  // resend an unchanged window at least this often
+#define KEYFRAME_INTERVAL_MS 500   // compressed mode: send a frame without deltas at least this often
+
+// every light in range receives each frame and picks out its own slots,
+// so adding lights doesn't add packets
+uint8_t broadcastAddress[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
 volatile uint8_t dmxRxData[DMX_CHANNELS + 1]; // slot 0 = start code
 volatile bool dmxFrameReady = false;
@@ -24,22 +42,46 @@ volatile bool dmxFrameReady = false;
 // struct to hold JSON config data
 struct config{
   bool valid;
-  uint8_t dmx_start_channel;
-  uint8_t dmx_forward_channels;
+  uint16_t dmx_start_channel;
+  uint16_t dmx_forward_channels;
+  bool forward_on_change;  // only send when the forwarded window changed
+  bool frame_sync;         // forward once per received DMX frame instead of on a timer
+  uint16_t keepalive_ms;   // max time between sends when nothing changed
+  uint8_t dmx_universes;   // number of DMX inputs to forward (1 or 2)
+  bool compress;           // RLE/delta encode the ESP-NOW payload
+  uint8_t group;           // ESP-NOW group, lights of other groups ignore this bridge
 };
 
-// struct that holds the DMX data to be sent via ESP-NOW
-// struct DMXDataPacket {
-//   uint8_t red;
-//   uint8_t green;
-//   uint8_t blue;
-//   uint8_t white;
-// } dmxPacket;
+// ESP-NOW packet being built, see DMXNowPacket.h for the wire format
+DMXNowFrame txFrame;
+
+// forwarding state per DMX input
+struct UniverseForward {
+  ESP32S3DMX* input;
+  uint8_t window[DMX_CHANNELS];   // window being forwarded, read from one DMX frame
+  uint8_t lastSent[DMX_CHANNELS]; // window of the last frame sent for this universe
+  uint16_t lastSentCount;        // valid bytes in lastSent, 0 = nothing sent yet
+  uint16_t lastSentStart;        // first slot of lastSent
+  unsigned long lastKeyframeTime; // last frame sent without deltas
+  unsigned long lastForwardTime; // last time a frame was sent
+  uint32_t lastSequence;         // DMX frame sequence of the last forwarded sample
+  uint16_t packetSequence;       // ESP-NOW frame counter for this universe
+  bool pending;                  // a sample is waiting for the radio, send the latest window
+};
+
+// frame handed to ESP-NOW, completed by OnDataSent() in send order
+struct InFlightFrame {
+  uint8_t packetsLeft; // send callbacks still to come
+  bool complete;       // every fragment was queued, so its delivery time counts
+  int64_t sentUs;      // when the first fragment was queued
+};
 
-struct DMXDataPacket {
-  uint8_t data[49]; // 1+(6*8)=49 channels there is 1 mode selection, and then max of 8 segments and every segment has 6 channels (start led, end led, r, g, b, w)
-  uint8_t count;
-} dmxPacket;
+// last link report of one light
+struct LightLink {
+  uint8_t mac[6];
+  unsigned long lastSeen; // millis() of the last report, 0 = free slot
+  DMXNowTelemetry report;
+};
 
 void receiveDMX();
 void setupWebServerRoutes();
@@ -48,11 +90,51 @@ void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
 void handleWebSocketMessage(void *arg, uint8_t *data, size_t len);
 config readJSONFile(const char* path);
 void OnDataSent(const uint8_t *mac_addr, esp_now_send_status_t status);
+void OnDataRecv(const uint8_t *mac_addr, const uint8_t *data, int len);
 uint32_t Wheel(byte WheelPos);
+bool forwardDMX(UniverseForward &u, uint8_t universe, unsigned long now);
+bool releaseSentFrames();
 
 bool serialAvailable = false;
-uint8_t dmxStartChannel = 1; // starting channel to forward
-uint8_t dmxForwardChannel = 32; // number of channels to forward by espnow
+uint16_t dmxStartChannel = 1; // starting channel to forward
+uint16_t dmxForwardChannel = 32; // number of channels to forward by espnow, up to the full universe
+bool forwardOnChange = true; // suppress sends of an unchanged window
+uint16_t keepaliveInterval = KEEPALIVE_DEFAULT_MS; // ms between keepalive sends
+bool frameSync = false; // forward on the DMX frame clock instead of FORWARD_INTERVAL_MS
+uint8_t dmxUniverseCount = 1; // DMX inputs in use
+bool compressPayload = false; // send RLE/delta encoded payloads with periodic keyframes
+uint8_t espnowGroup = DMXNOW_GROUP_DEFAULT; // group ID sent in every packet
+
+// forwarding statistics
+uint32_t framesSent = 0;       // frames handed to esp_now_send
+uint32_t fragmentsSent = 0;    // ESP-NOW packets, a frame is sent as 1-3 fragments
+uint32_t framesSuppressed = 0; // unchanged windows that were not sent
+uint32_t framesSkipped = 0;    // DMX frames that completed without being forwarded (frame sync)
+int64_t forwardLatencyUs = 0;  // frame complete -> esp_now_send() returned, last send
+int64_t maxForwardLatencyUs = 0; // worst latency since boot
+uint32_t keyframesSent = 0;    // compressed mode: frames sent without deltas
+uint32_t slotBytesSent = 0;    // slot values carried by the sent fragments
+uint32_t payloadBytesSent = 0; // payload bytes actually sent for them
+int64_t encodeUs = 0;          // time to encode the last frame
+int64_t maxEncodeUs = 0;       // worst encode time since boot
+uint32_t sendErrors = 0;       // esp_now_send() refused a packet
+uint32_t deliveryFailures = 0; // send callbacks reporting the packet did not go out
+uint32_t framesDropped = 0;    // samples replaced by a newer one while the radio was busy
+uint32_t sendRate = 0;         // frames per second sent over the last second
+uint16_t forwardIntervalMs = FORWARD_INTERVAL_MS; // sampling interval adapted to the delivery time
+
+// send pacing, shared with OnDataSent() on the WiFi task
+portMUX_TYPE sendMux = portMUX_INITIALIZER_UNLOCKED;
+InFlightFrame inFlight[MAX_FRAMES_IN_FLIGHT];
+uint8_t inFlightHead = 0;
+uint8_t inFlightCount = 0;
+uint8_t orphanCallbacks = 0;   // callbacks still owed for a frame given up on
+uint32_t deliveryUs = 0;       // moving average of first fragment queued -> last packet sent
+TaskHandle_t loopTask = nullptr; // woken when a frame left the radio
+
+// link reports from the lights, written by OnDataRecv() on the WiFi task
+portMUX_TYPE linkMux = portMUX_INITIALIZER_UNLOCKED;
+LightLink links[MAX_LINKS];
 
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
@@ -60,6 +142,9 @@ AsyncWebSocket ws("/ws");
 esp_now_peer_info_t peerInfo;
 
 ESP32S3DMX dmx;
+ESP32S3DMXPort<DMX2_UART, DMX2_RX_PIN, DMX2_TX_PIN, DMX2_EN_PIN> dmx2;
+
+UniverseForward universes[DMX_UNIVERSES_MAX] = { {&dmx}, {&dmx2} };
 
 // create NeoPixel strip object (1 LED, connected to PIN_NEO_PIXEL), RGB 
 Adafruit_NeoPixel led = Adafruit_NeoPixel(NUM_LEDS, PIN_NEO_PIXEL, NEO_GRB + NEO_KHZ800);
@@ -90,8 +175,9 @@ void setup() {
   }
 
   esp_now_register_send_cb(esp_now_send_cb_t(OnDataSent));
+  esp_now_register_recv_cb(esp_now_recv_cb_t(OnDataRecv));
 
-  // register peer
+  // register the broadcast peer
   memcpy(peerInfo.peer_addr, broadcastAddress, 6);
   peerInfo.channel = 0; // use current channel
   peerInfo.encrypt = false;
@@ -104,8 +190,6 @@ void setup() {
   
   setupWebServerRoutes();
 
-  dmx.begin();
-
   led.begin();
   led.show();
   led.setBrightness(255);
@@ -115,11 +199,33 @@ void setup() {
   if (cfg.valid) {
     dmxStartChannel = cfg.dmx_start_channel;
     dmxForwardChannel = cfg.dmx_forward_channels;
-    if (serialAvailable) Serial.printf("Config loaded: Start Channel=%d, Forward Channels=%d\n", dmxStartChannel, dmxForwardChannel);
+    forwardOnChange = cfg.forward_on_change;
+    keepaliveInterval = cfg.keepalive_ms;
+    frameSync = cfg.frame_sync;
+    dmxUniverseCount = constrain(cfg.dmx_universes, 1, DMX_UNIVERSES_MAX);
+    compressPayload = cfg.compress;
+    espnowGroup = cfg.group;
+    if (serialAvailable) Serial.printf("Config loaded: Start Channel=%d, Forward Channels=%d, On Change=%d, Keepalive=%d ms, Frame Sync=%d, Universes=%d, Compress=%d, Group=%d\n",
+                                       dmxStartChannel, dmxForwardChannel, forwardOnChange, keepaliveInterval, frameSync, dmxUniverseCount, compressPayload, espnowGroup);
   } else {
     if (serialAvailable) Serial.println("Using default config: Start Channel=1, Forward Channels=4");
   }
 
+  // without the first input the web UI still comes up, so the config can be fixed
+  if (!dmx.begin()) {
+    if (serialAvailable) Serial.println("Failed to start DMX input, universe 0 is not forwarded");
+  }
+  if (dmxUniverseCount > 1 && !dmx2.begin()) {
+    if (serialAvailable) Serial.println("Failed to start second DMX input, forwarding one universe");
+    dmxUniverseCount = 1;
+  }
+  // setup() and loop() share the loop task, wake it on a frame from any input
+  // and whenever the radio can take the next frame
+  loopTask = xTaskGetCurrentTaskHandle();
+  for (uint8_t i = 0; i < dmxUniverseCount; i++) {
+    universes[i].input->notifyOnFrame(xTaskGetCurrentTaskHandle());
+  }
+
   if (serialAvailable) Serial.println("DXM Receiver Setup complete!");
 
    led.setPixelColor(1, led.Color(125, 0, 0)); // Red for no signal
@@ -129,37 +235,52 @@ void setup() {
 void loop() {
   unsigned long now = millis();
   static unsigned long lastSend = 0;
+  static unsigned long lastStats = 0;
+  static unsigned long lastRate = 0;
+  static uint32_t framesAtLastRate = 0;
 
-  if (dmx.isConnected()) {
+  bool connected = false;
+  for (uint8_t i = 0; i < dmxUniverseCount; i++) {
+    if (universes[i].input->isConnected()) connected = true;
+  }
+
+  if (connected) {
     
-    // send update to esp-now every 300 ms or when a new frame is ready
-    if (now - lastSend >= 10) {
+    // sample the forwarded window every forwardIntervalMs
+    if (now - lastSend >= forwardIntervalMs) {
       lastSend = now;
-      dmxFrameReady = true;
+      if (!frameSync) dmxFrameReady = true;
       led.fill(led.Color(0, 125, 0)); // Green for DMX signal
       led.show();
     }
 
-    if (dmxFrameReady) {
-      dmxFrameReady = false;
-      for (uint8_t i = 0; i < dmxForwardChannel && (dmxStartChannel + i) <= DMX_CHANNELS; i++) {
-        dmxPacket.data[i] = dmx.read(dmxStartChannel + i);
-      }
-      // dmxPacket.red = dmx.read(dmxStartChannel);
-      // dmxPacket.green = dmx.read(dmxStartChannel + 1);  
-      // dmxPacket.blue = dmx.read(dmxStartChannel + 2);
-      // dmxPacket.white = dmx.read(dmxStartChannel + 3);
-
-      Serial.printf("Forwarding DMX channels %d-%d\n", 
-                    dmxStartChannel, dmxStartChannel + dmxForwardChannel - 1);
-
-      esp_err_t result = esp_now_send(broadcastAddress, (uint8_t *) &dmxPacket, sizeof(dmxPacket));
-      if (result == ESP_OK) {
-        if (serialAvailable) Serial.println("DMX data sent via ESP-NOW");
-      } else {
-        if (serialAvailable) Serial.println("Error sending DMX data via ESP-NOW");
+    if (frameSync) {
+      // block until an input publishes its next frame; bounded so the
+      // LED and stats keep running if the console stops sending
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FORWARD_INTERVAL_MS));
+    }
+
+    for (uint8_t i = 0; i < dmxUniverseCount; i++) {
+      UniverseForward &u = universes[i];
+      if (!u.input->isConnected()) continue;
+
+      if (frameSync) {
+        uint32_t seq = u.input->getFrameSequence();
+        if (seq != u.lastSequence) {
+          if (u.lastSequence != 0) framesSkipped += seq - u.lastSequence - 1;
+          if (u.pending) framesDropped++;
+          u.lastSequence = seq;
+        } else if (!u.pending) {
+          continue;
+        }
+      } else if (dmxFrameReady) {
+        if (u.pending) framesDropped++;
+      } else if (!u.pending) {
+        continue;
       }
+      forwardDMX(u, i, now);
     }
+    dmxFrameReady = false;
   } else {
       // Serial.print("No DMX signal");
       // uint32_t lastPacket = dmx.timeSinceLastPacket();
@@ -173,6 +294,159 @@ void loop() {
       led.show();
       delay(10);
   }
+
+  if (now - lastRate >= 1000) {
+    sendRate = (framesSent - framesAtLastRate) * 1000 / (now - lastRate);
+    framesAtLastRate = framesSent;
+    lastRate = now;
+
+    // don't sample faster than the radio delivers a round of frames
+    portENTER_CRITICAL(&sendMux);
+    uint32_t roundUs = deliveryUs * dmxUniverseCount;
+    portEXIT_CRITICAL(&sendMux);
+    forwardIntervalMs = max((uint32_t)FORWARD_INTERVAL_MS, (roundUs + 999) / 1000);
+  }
+
+  if (now - lastStats >= 5000) {
+    lastStats = now;
+    if (serialAvailable) {
+      Serial.printf("ESP-NOW forwarding: sent=%u (%u fragments) suppressed=%u skipped=%u latency=%lld us (max %lld us), UART callbacks/frame=%u\n",
+                    framesSent, fragmentsSent, framesSuppressed, framesSkipped, forwardLatencyUs, maxForwardLatencyUs,
+                    dmx.getCallbacksPerFrame());
+      Serial.printf("ESP-NOW pacing: %u frames/s, interval=%u ms, delivery=%u us, dropped=%u, send errors=%u, delivery failures=%u\n",
+                    sendRate, forwardIntervalMs, deliveryUs, framesDropped, sendErrors, deliveryFailures);
+      if (compressPayload && slotBytesSent > 0) {
+        Serial.printf("Compression: %u slots in %u payload bytes (%.2f), keyframes=%u, encode=%lld us (max %lld us)\n",
+                      slotBytesSent, payloadBytesSent, (float)payloadBytesSent / slotBytesSent,
+                      keyframesSent, encodeUs, maxEncodeUs);
+      }
+      for (uint8_t i = 0; i < dmxUniverseCount; i++) {
+        DMXStats st;
+        universes[i].input->getStats(st);
+        Serial.printf("DMX input %d: %.1f Hz, interval min/avg/max=%u/%u/%u us, short break intervals=%u framing=%u overruns=%u alt start codes=%u\n",
+                      i + 1, st.packetRate, st.intervalMinUs, st.intervalAvgUs, st.intervalMaxUs,
+                      st.shortBreakIntervals, st.framingErrors, st.overruns, st.nonZeroStartCodes);
+      }
+    }
+  }
+}
+
+// ===== Forward DMX window via ESP-NOW =====
+// Reads the configured window of one universe from a single DMX frame and
+// sends it as one or more fragments of up to DMXNOW_MAX_PAYLOAD slots that
+// share a frame sequence number.
+// In change-driven mode an unchanged window is suppressed until the keepalive
+// interval expires. In compressed mode each fragment is sent as a delta
+// against the last sent frame or RLE, whichever is smaller, with a keyframe
+// every KEYFRAME_INTERVAL_MS.
+// At most MAX_FRAMES_IN_FLIGHT frames wait for the radio; while it is busy
+// the universe is marked pending and its latest window is sent as soon as
+// OnDataSent() frees a slot. Returns true if the frame was handed to ESP-NOW.
+bool forwardDMX(UniverseForward &u, uint8_t universe, unsigned long now) {
+  portENTER_CRITICAL(&sendMux);
+  // a lost callback must not stall forwarding. Late callbacks of the frame
+  // given up on are swallowed by OnDataSent(); debt of an older timeout is
+  // presumed lost by now.
+  if (inFlightCount > 0 && esp_timer_get_time() - inFlight[inFlightHead].sentUs > SEND_TIMEOUT_MS * 1000) {
+    orphanCallbacks = inFlight[inFlightHead].packetsLeft;
+    inFlight[inFlightHead].packetsLeft = 0;
+    inFlight[inFlightHead].complete = false;
+    deliveryFailures++;
+    releaseSentFrames();
+  }
+  bool busy = inFlightCount >= MAX_FRAMES_IN_FLIGHT;
+  portEXIT_CRITICAL(&sendMux);
+  if (busy) {
+    u.pending = true;
+    return false;
+  }
+  u.pending = false;
+
+  // never copy past the end of the universe
+  uint16_t start = constrain(dmxStartChannel, 1, DMX_CHANNELS);
+  uint16_t count = min(dmxForwardChannel, (uint16_t)(DMX_CHANNELS + 1 - start));
+
+  // take the whole window from one frame, zero what the frame didn't carry
+  uint16_t got = u.input->readChannels(u.window, start, count);
+  memset(u.window + got, 0, count - got);
+
+  if (forwardOnChange && u.lastSentCount == count &&
+      now - u.lastForwardTime < keepaliveInterval &&
+      memcmp(u.window, u.lastSent, count) == 0) {
+    framesSuppressed++;
+    return false;
+  }
+
+  // deltas need the receiver to hold the previous frame of the same window
+  bool keyframe = u.lastSentCount != count || u.lastSentStart != start ||
+                  now - u.lastKeyframeTime >= KEYFRAME_INTERVAL_MS;
+  int64_t encodeTime = 0;
+
+  uint8_t fragments = count == 0 ? 1 : (count + DMXNOW_MAX_PAYLOAD - 1) / DMXNOW_MAX_PAYLOAD;
+
+  // queue the frame before its first callback can arrive
+  portENTER_CRITICAL(&sendMux);
+  InFlightFrame &pendingFrame = inFlight[(inFlightHead + inFlightCount) % MAX_FRAMES_IN_FLIGHT];
+  pendingFrame.packetsLeft = fragments;
+  pendingFrame.complete = true;
+  pendingFrame.sentUs = esp_timer_get_time();
+  inFlightCount++;
+  portEXIT_CRITICAL(&sendMux);
+
+  for (uint8_t f = 0; f < fragments; f++) {
+    uint16_t offset = f * DMXNOW_MAX_PAYLOAD;
+    uint16_t length = min((uint16_t)(count - offset), (uint16_t)DMXNOW_MAX_PAYLOAD);
+
+    uint8_t flags = 0;
+    uint16_t encoded = length;
+    if (compressPayload) {
+      int64_t t0 = esp_timer_get_time();
+      encoded = dmxNowEncodePayload(txFrame.payload, u.window + offset,
+                                    keyframe ? nullptr : u.lastSent + offset, length, flags);
+      encodeTime += esp_timer_get_time() - t0;
+    } else {
+      memcpy(txFrame.payload, u.window + offset, length);
+    }
+    size_t size = dmxNowFinish(txFrame, universe, u.packetSequence, start + offset, length,
+                               f, fragments, flags, encoded, espnowGroup);
+    esp_err_t result = esp_now_send(broadcastAddress, (uint8_t *) &txFrame, size);
+    if (result != ESP_OK) {
+      // the receiver drops the incomplete frame; resend it all as a keyframe next time
+      if (serialAvailable) Serial.println("Error sending DMX data via ESP-NOW");
+      sendErrors++;
+      portENTER_CRITICAL(&sendMux);
+      pendingFrame.packetsLeft -= fragments - f; // no callbacks for these
+      pendingFrame.complete = false;
+      releaseSentFrames();
+      portEXIT_CRITICAL(&sendMux);
+      u.packetSequence++;
+      u.lastSentCount = 0;
+      return false;
+    }
+    fragmentsSent++;
+    slotBytesSent += length;
+    payloadBytesSent += size - DMXNOW_HEADER_SIZE;
+  }
+  if (compressPayload) {
+    encodeUs = encodeTime;
+    if (encodeUs > maxEncodeUs) maxEncodeUs = encodeUs;
+    if (keyframe) {
+      u.lastKeyframeTime = now;
+      keyframesSent++;
+    }
+  }
+
+  // age of the forwarded frame when it was handed to the radio
+  forwardLatencyUs = esp_timer_get_time() - u.input->getLastFrameTime();
+  if (forwardLatencyUs > maxForwardLatencyUs) maxForwardLatencyUs = forwardLatencyUs;
+
+  memcpy(u.lastSent, u.window, count);
+  u.lastSentCount = count;
+  u.lastSentStart = start;
+  u.packetSequence++;
+  u.lastForwardTime = now;
+  framesSent++;
+  return true;
 }
 
 uint32_t Wheel(byte WheelPos) {
@@ -199,6 +473,12 @@ void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
             // JsonDocument doc;
             doc["start"] = dmxStartChannel;
             doc["count"] = dmxForwardChannel;
+            doc["onChange"] = forwardOnChange;
+            doc["keepalive"] = keepaliveInterval;
+            doc["frameSync"] = frameSync;
+            doc["universes"] = dmxUniverseCount;
+            doc["compress"] = compressPayload;
+            doc["group"] = espnowGroup;
 
             String msg;
             serializeJson(doc, msg);
@@ -234,6 +514,26 @@ void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
         dmxForwardChannel = doc["count"];
     }
 
+    if(doc.containsKey("onChange")){
+        forwardOnChange = doc["onChange"];
+    }
+
+    if(doc.containsKey("keepalive")){
+        keepaliveInterval = doc["keepalive"];
+    }
+
+    if(doc.containsKey("frameSync")){
+        frameSync = doc["frameSync"];
+    }
+
+    if(doc.containsKey("compress")){
+        compressPayload = doc["compress"];
+    }
+
+    if(doc.containsKey("group")){
+        espnowGroup = doc["group"];
+    }
+
     // if(doc["start"]){
     //     dmxStartChannel = doc["start"];
     // }
@@ -242,13 +542,20 @@ void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
     //     dmxForwardChannel = doc["count"];
     // }
 
-    Serial.printf("New config: start=%d count=%d\n", dmxStartChannel, dmxForwardChannel);
+    Serial.printf("New config: start=%d count=%d onChange=%d keepalive=%d frameSync=%d compress=%d group=%d\n",
+                  dmxStartChannel, dmxForwardChannel, forwardOnChange, keepaliveInterval, frameSync, compressPayload, espnowGroup);
 
     // save to SPIFFS
     DynamicJsonDocument saveDoc(256);
     // JsonDocument saveDoc;
     saveDoc["dmx_start_channel"] = dmxStartChannel;
     saveDoc["dmx_forward_channels"] = dmxForwardChannel;
+    saveDoc["forward_on_change"] = forwardOnChange;
+    saveDoc["keepalive_ms"] = keepaliveInterval;
+    saveDoc["frame_sync"] = frameSync;
+    saveDoc["dmx_universes"] = dmxUniverseCount;
+    saveDoc["compress_payload"] = compressPayload;
+    saveDoc["espnow_group"] = espnowGroup;
 
     File file = SPIFFS.open("/config.json","w");
     serializeJson(saveDoc,file);
@@ -282,6 +589,98 @@ void setupWebServerRoutes() {
       request->send(SPIFFS, "/image/favicon.ico", "image/favicon.ico");
   });
 
+  // FORWARDING STATISTICS
+  server.on("/stats", HTTP_GET, [](AsyncWebServerRequest *request){
+      DynamicJsonDocument doc(6144);
+      doc["sent"] = framesSent;
+      doc["fragments"] = fragmentsSent;
+      doc["suppressed"] = framesSuppressed;
+      doc["callbacksPerFrame"] = dmx.getCallbacksPerFrame();
+      doc["skipped"] = framesSkipped;
+      doc["latencyUs"] = forwardLatencyUs;
+      doc["maxLatencyUs"] = maxForwardLatencyUs;
+      doc["onChange"] = forwardOnChange;
+      doc["keepalive"] = keepaliveInterval;
+      doc["frameSync"] = frameSync;
+      doc["compress"] = compressPayload;
+      doc["keyframes"] = keyframesSent;
+      doc["slotBytes"] = slotBytesSent;
+      doc["payloadBytes"] = payloadBytesSent;
+      doc["compressionRatio"] = slotBytesSent ? (float)payloadBytesSent / slotBytesSent : 1.0f;
+      doc["encodeUs"] = encodeUs;
+      doc["maxEncodeUs"] = maxEncodeUs;
+      doc["sendRate"] = sendRate;
+      doc["intervalMs"] = forwardIntervalMs;
+      doc["deliveryUs"] = deliveryUs;
+      doc["dropped"] = framesDropped;
+      doc["sendErrors"] = sendErrors;
+      doc["deliveryFailures"] = deliveryFailures;
+
+      // link reports of the lights, stale ones are dropped
+      JsonArray lights = doc.createNestedArray("links");
+      unsigned long now = millis();
+      portENTER_CRITICAL(&linkMux);
+      LightLink snapshot[MAX_LINKS];
+      for (uint8_t i = 0; i < MAX_LINKS; i++) {
+        if (links[i].lastSeen && now - links[i].lastSeen > LINK_STALE_MS) links[i].lastSeen = 0;
+        snapshot[i] = links[i];
+      }
+      portEXIT_CRITICAL(&linkMux);
+      for (uint8_t i = 0; i < MAX_LINKS; i++) {
+        if (!snapshot[i].lastSeen) continue;
+        const DMXNowTelemetry &rep = snapshot[i].report;
+        char mac[18];
+        snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", snapshot[i].mac[0], snapshot[i].mac[1],
+                 snapshot[i].mac[2], snapshot[i].mac[3], snapshot[i].mac[4], snapshot[i].mac[5]);
+        uint32_t expected = rep.framesComplete + rep.framesPartial + rep.framesLost;
+
+        JsonObject light = lights.createNestedObject();
+        light["mac"] = mac;
+        light["ageMs"] = now - snapshot[i].lastSeen;
+        light["universe"] = rep.universe;
+        light["address"] = rep.address;
+        light["rssi"] = rep.rssi;
+        light["fps"] = rep.renderFps;
+        light["complete"] = rep.framesComplete;
+        light["partial"] = rep.framesPartial;
+        light["lost"] = rep.framesLost;
+        light["loss"] = expected ? 100.0f * (expected - rep.framesComplete) / expected : 0.0f;
+        light["intervalUs"] = rep.intervalUs;
+        light["jitterUs"] = rep.jitterUs;
+      }
+
+      // DMX input timing and error statistics per universe
+      JsonArray inputs = doc.createNestedArray("inputs");
+      for (uint8_t i = 0; i < dmxUniverseCount; i++) {
+        DMXStats st;
+        universes[i].input->getStats(st);
+
+        JsonObject in = inputs.createNestedObject();
+        in["rate"] = st.packetRate;
+        in["intervalMinUs"] = st.intervalMinUs;
+        in["intervalAvgUs"] = st.intervalAvgUs;
+        in["intervalMaxUs"] = st.intervalMaxUs;
+        in["shortBreakIntervals"] = st.shortBreakIntervals;
+        in["framingErrors"] = st.framingErrors;
+        in["overruns"] = st.overruns;
+        in["altStartCodes"] = st.nonZeroStartCodes;
+        JsonArray jitter = in.createNestedArray("jitter");
+        for (uint8_t b = 0; b < DMX_JITTER_BUCKETS; b++) jitter.add(st.jitterHistogram[b]);
+        JsonArray slots = in.createNestedArray("slots");
+        for (uint8_t b = 0; b < DMX_SLOT_BUCKETS; b++) slots.add(st.slotHistogram[b]);
+      }
+
+      String msg;
+      serializeJson(doc, msg);
+      request->send(200, "application/json", msg);
+  });
+
+  // RESET DMX INPUT STATISTICS
+  server.on("/resetStats", HTTP_POST, [](AsyncWebServerRequest *request){
+      for (uint8_t i = 0; i < dmxUniverseCount; i++) universes[i].input->resetStats();
+      request->send(200, "text/plain", "Statistics reset");
+  });
+
   // DOWNLOAD CONFIG
   server.on("/downloadConfig", HTTP_GET, [](AsyncWebServerRequest *request){
       request->send(SPIFFS, "/config.json", "application/json", true);
@@ -360,7 +759,7 @@ config readJSONFile(const char* path) {
   File file = SPIFFS.open(path, "r");
   if (!file) {
     if (serialAvailable) Serial.println("Failed to open config file");
-    return {false, 1, 4}; // return empty config on failure
+    return {false, 1, 4, true, false, KEEPALIVE_DEFAULT_MS, 1, false, DMXNOW_GROUP_DEFAULT}; // return empty config on failure
   }
 
   static  DynamicJsonDocument doc(1024);
@@ -372,10 +771,77 @@ config readJSONFile(const char* path) {
   cfg.valid = true;
   cfg.dmx_start_channel = doc["dmx_start_channel"] | 1; // default to 1
   cfg.dmx_forward_channels = doc["dmx_forward_channels"] | 4; // default to 4
+  cfg.forward_on_change = doc["forward_on_change"] | true; // default to change-driven
+  cfg.keepalive_ms = doc["keepalive_ms"] | KEEPALIVE_DEFAULT_MS;
+  cfg.frame_sync = doc["frame_sync"] | false; // default to timer-driven
+  cfg.dmx_universes = doc["dmx_universes"] | 1; // second input is opt-in
+  cfg.compress = doc["compress_payload"] | false; // raw payloads unless enabled
+  cfg.group = doc["espnow_group"] | DMXNOW_GROUP_DEFAULT;
   return cfg;
 }
 
+// Drop finished frames from the head of the in-flight queue and fold their
+// delivery time into deliveryUs. Call with sendMux held.
+// Returns true if a slot was freed.
+bool releaseSentFrames() {
+  bool freed = false;
+  while (inFlightCount > 0 && inFlight[inFlightHead].packetsLeft == 0) {
+    InFlightFrame &done = inFlight[inFlightHead];
+    if (done.complete) {
+      int32_t sample = esp_timer_get_time() - done.sentUs;
+      deliveryUs = deliveryUs == 0 ? sample : deliveryUs + (sample - (int32_t)deliveryUs) / 8;
+    }
+    inFlightHead = (inFlightHead + 1) % MAX_FRAMES_IN_FLIGHT;
+    inFlightCount--;
+    freed = true;
+  }
+  return freed;
+}
+
+// Link report from a light: keep the latest one per MAC address, reusing
+// the oldest slot when the table is full.
+void OnDataRecv(const uint8_t *mac_addr, const uint8_t *data, int len) {
+  const DMXNowTelemetry *report = dmxNowDecodeTelemetry(data, len);
+  if (!report || report->group != espnowGroup) return;
+
+  unsigned long now = millis();
+  portENTER_CRITICAL(&linkMux);
+  LightLink *slot = nullptr, *freeSlot = nullptr, *oldest = &links[0];
+  for (uint8_t i = 0; i < MAX_LINKS; i++) {
+    LightLink &l = links[i];
+    if (!l.lastSeen) {
+      if (!freeSlot) freeSlot = &l;
+      continue;
+    }
+    if (memcmp(l.mac, mac_addr, 6) == 0) {
+      slot = &l;
+      break;
+    }
+    if (now - l.lastSeen > now - oldest->lastSeen) oldest = &l;
+  }
+  if (!slot) slot = freeSlot ? freeSlot : oldest;
+  memcpy(slot->mac, mac_addr, 6);
+  slot->lastSeen = now ? now : 1;
+  slot->report = *report;
+  portEXIT_CRITICAL(&linkMux);
+}
+
+// Broadcasts are not acknowledged: the callback only says the packet left
+// the radio. Callbacks arrive in send order, so they complete the oldest
+// in-flight frame and wake loop() to send whatever is pending. Callbacks
+// still owed for a timed-out frame come first and must not count against
+// the next one.
 void OnDataSent(const uint8_t *mac_addr, esp_now_send_status_t status) {
-  Serial.print("Last Packet Send Status: ");
-  Serial.println(status == ESP_NOW_SEND_SUCCESS ? "Delivery Success" : "Delivery Fail");
+  portENTER_CRITICAL(&sendMux);
+  if (orphanCallbacks > 0) {
+    orphanCallbacks--;
+    portEXIT_CRITICAL(&sendMux);
+    return;
+  }
+  if (status != ESP_NOW_SEND_SUCCESS) deliveryFailures++;
+  if (inFlightCount > 0 && inFlight[inFlightHead].packetsLeft > 0) inFlight[inFlightHead].packetsLeft--;
+  bool freed = releaseSentFrames();
+  portEXIT_CRITICAL(&sendMux);
+
+  if (freed && loopTask) xTaskNotifyGive(loopTask);
 }
\ No newline at end of file
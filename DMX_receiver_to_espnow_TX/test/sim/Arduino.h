@@ -0,0 +1,57 @@
+/*
+  Arduino.h - host-native shim for the ESP32S3DMX line simulator
+
+  Provides only what the ESP32S3DMX library uses. Time is driven by the
+  simulator (see HardwareSerial.h) instead of a hardware clock, so test
+  runs are deterministic.
+*/
+
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+namespace sim {
+    /// Simulated time in microseconds, advanced by the line simulator
+    inline int64_t& clockUs() {
+        static int64_t now = 0;
+        return now;
+    }
+    
+    /// Advance simulated time
+    inline void advance(int64_t us) { clockUs() += us; }
+}
+
+inline unsigned long millis() { return (unsigned long)(sim::clockUs() / 1000); }
+inline unsigned long micros() { return (unsigned long)sim::clockUs(); }
+inline void delay(unsigned long ms) { sim::advance((int64_t)ms * 1000); }
+inline void delayMicroseconds(unsigned int us) { sim::advance(us); }
+
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+
+// FreeRTOS task notifications, counted instead of delivered
+typedef void* TaskHandle_t;
+
+namespace sim {
+    /// Number of task notifications sent since start
+    inline uint32_t& notifications() {
+        static uint32_t count = 0;
+        return count;
+    }
+}
+
+inline int xTaskNotifyGive(TaskHandle_t) { sim::notifications()++; return 1; }
+
+#endif // SIM_ARDUINO_H
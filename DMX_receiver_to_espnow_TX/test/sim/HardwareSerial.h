@@ -0,0 +1,154 @@
+/*
+  HardwareSerial.h - simulated UART for the ESP32S3DMX line simulator
+
+  Models the parts of the Arduino Core 3 UART the DMX receiver relies on:
+  a receive ring buffer, the RX FIFO-full threshold and RX timeout that
+  decide when onReceive() fires, and break/error reporting through
+  onReceiveError(). Bytes are fed by the test through feed() and breaks
+  through lineBreak(); simulated time advances at 250 kbaud.
+*/
+
+#ifndef SIM_HARDWARE_SERIAL_H
+#define SIM_HARDWARE_SERIAL_H
+
+#include "Arduino.h"
+#include <deque>
+#include <functional>
+
+#define SERIAL_8N2 0x800003c
+
+#define SIM_UART_COUNT 3
+#define SIM_SYMBOL_US 44        ///< One 11-bit slot at 250 kbaud
+#define SIM_FIFO_SIZE 128       ///< Hardware RX FIFO size
+
+typedef enum {
+    UART_NO_ERROR,
+    UART_BREAK_ERROR,
+    UART_BUFFER_FULL_ERROR,
+    UART_FIFO_OVF_ERROR,
+    UART_FRAME_ERROR,
+    UART_PARITY_ERROR
+} hardwareSerial_error_t;
+
+class HardwareSerial {
+public:
+    explicit HardwareSerial(uint8_t uart_nr) : uartNum(uart_nr), rxBufferSize(256),
+        rxFIFOFull(120), rxTimeout(2), pendingFifo(0), running(false) {
+        registry()[uartNum] = this;
+    }
+    
+    ~HardwareSerial() {
+        if (registry()[uartNum] == this) {
+            registry()[uartNum] = nullptr;
+        }
+    }
+    
+    void begin(unsigned long, uint32_t = SERIAL_8N2, int8_t = -1, int8_t = -1,
+               bool = false, unsigned long = 20000UL, uint8_t rxfifo_full_thrhd = 120) {
+        rxFIFOFull = rxfifo_full_thrhd;
+        running = true;
+    }
+    
+    void end() { running = false; rx.clear(); }
+    
+    size_t setRxBufferSize(size_t size) { rxBufferSize = size; return size; }
+    size_t setTxBufferSize(size_t size) { return size; }
+    bool setRxFIFOFull(uint8_t threshold) { rxFIFOFull = threshold; return true; }
+    bool setRxTimeout(uint8_t symbols) { rxTimeout = symbols; return true; }
+    
+    void onReceive(std::function<void(void)> cb, bool = false) { receiveCb = cb; }
+    void onReceiveError(std::function<void(hardwareSerial_error_t)> cb) { errorCb = cb; }
+    
+    int available() { return (int)rx.size(); }
+    
+    int read() {
+        if (rx.empty()) {
+            return -1;
+        }
+        uint8_t b = rx.front();
+        rx.pop_front();
+        return b;
+    }
+    
+    size_t read(uint8_t* buffer, size_t size) {
+        size_t n = min(size, rx.size());
+        std::copy(rx.begin(), rx.begin() + n, buffer);
+        rx.erase(rx.begin(), rx.begin() + n);
+        return n;
+    }
+    
+    // ===== Simulator side =====
+    
+    /// UART instance created for a peripheral number, nullptr if none
+    static HardwareSerial* port(uint8_t uart_nr) { return registry()[uart_nr]; }
+    
+    /// Receive bytes on the line; fires onReceive() at the FIFO threshold
+    void feed(const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            sim::advance(SIM_SYMBOL_US);
+            if (rx.size() >= rxBufferSize) {
+                reportError(UART_BUFFER_FULL_ERROR);
+                continue;
+            }
+            rx.push_back(data[i]);
+            if (++pendingFifo >= rxFIFOFull) {
+                deliver();
+            }
+        }
+    }
+    
+    /// Line goes idle long enough for the RX timeout to deliver a partial FIFO
+    void idle(int64_t us) {
+        sim::advance(us);
+        if (pendingFifo > 0 && us >= (int64_t)rxTimeout * SIM_SYMBOL_US) {
+            deliver();
+        }
+    }
+    
+    /// Break and mark-after-break; the ESP32-S3 UART reports a frame error
+    /// right after the break and leaves a 0x00 artifact byte
+    void lineBreak(uint32_t breakUs = 176, uint32_t mabUs = 12, bool artifact = true) {
+        idle(breakUs);
+        if (errorCb) {
+            errorCb(UART_BREAK_ERROR);
+            errorCb(UART_FRAME_ERROR);
+        }
+        if (artifact) {
+            rx.push_back(0x00);
+            pendingFifo++;
+        }
+        sim::advance(mabUs);
+    }
+    
+    /// Report a UART error such as a framing error
+    void reportError(hardwareSerial_error_t error) {
+        if (errorCb) {
+            errorCb(error);
+        }
+    }
+    
+private:
+    static HardwareSerial** registry() {
+        static HardwareSerial* ports[SIM_UART_COUNT] = {nullptr};
+        return ports;
+    }
+    
+    void deliver() {
+        pendingFifo = 0;
+        if (running && receiveCb && !rx.empty()) {
+            receiveCb();
+        }
+    }
+    
+    uint8_t uartNum;
+    size_t rxBufferSize;
+    uint8_t rxFIFOFull;
+    uint8_t rxTimeout;
+    size_t pendingFifo;
+    bool running;
+    std::deque<uint8_t> rx;
+    std::function<void(void)> receiveCb;
+    std::function<void(hardwareSerial_error_t)> errorCb;
+};
+
+#endif // SIM_HARDWARE_SERIAL_H
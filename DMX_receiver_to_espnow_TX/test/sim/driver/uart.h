@@ -0,0 +1,23 @@
+/*
+  driver/uart.h - host-native shim for the ESP32S3DMX line simulator
+
+  Only lets ESP32S3DMXTX compile on the host; transmission is not simulated.
+*/
+
+#ifndef SIM_DRIVER_UART_H
+#define SIM_DRIVER_UART_H
+
+#include "Arduino.h"
+
+typedef int esp_err_t;
+typedef int uart_port_t;
+
+#define ESP_OK 0
+#define ESP_ERR_TIMEOUT 0x107
+#define pdMS_TO_TICKS(ms) (ms)
+
+inline int uart_write_bytes_with_break(uart_port_t, const void*, size_t size, int) { return (int)size; }
+inline esp_err_t uart_wait_tx_done(uart_port_t, uint32_t) { return ESP_OK; }
+inline esp_err_t uart_set_tx_idle_num(uart_port_t, uint16_t) { return ESP_OK; }
+
+#endif // SIM_DRIVER_UART_H
@@ -0,0 +1,12 @@
+/*
+  esp_timer.h - host-native shim for the ESP32S3DMX line simulator
+*/
+
+#ifndef SIM_ESP_TIMER_H
+#define SIM_ESP_TIMER_H
+
+#include "Arduino.h"
+
+inline int64_t esp_timer_get_time() { return sim::clockUs(); }
+
+#endif // SIM_ESP_TIMER_H
@@ -0,0 +1,379 @@
+/*
+  ESP32S3DMX line simulator tests
+
+  Runs the ESP32S3DMX frame logic on the host against the simulated UART
+  in test/sim. Replays synthetic and recorded DMX streams (short frames,
+  missing breaks, garbage, 44 Hz and max-rate) and checks what readers
+  see, then reports parse throughput.
+
+  Run with: pio test -e native -v
+*/
+
+#include <unity.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include "ESP32S3DMX.h"
+
+#define DMX_UART 2
+#define FRAME_44HZ_US 22727   ///< Break-to-break time at 44 Hz
+
+static HardwareSerial* uart = nullptr;
+
+// ===== Line helpers =====
+
+// Break followed by start code and channel data, not yet terminated
+static void sendFrame(const uint8_t* channels, uint16_t count, uint8_t startCode = 0) {
+    uart->lineBreak();
+    uart->feed(&startCode, 1);
+    uart->feed(channels, count);
+}
+
+// Terminate the frame in flight with the next break
+static void endFrame() {
+    uart->lineBreak();
+}
+
+static void fillPattern(uint8_t* channels, uint16_t count, uint8_t seed) {
+    for (uint16_t i = 0; i < count; i++) {
+        channels[i] = (uint8_t)(i * 7 + seed);
+    }
+}
+
+// Replay a capture. One event per line:
+//   B <break us> <mab us>   break and mark-after-break
+//   D <hex> <hex> ...       data bytes on the line
+//   I <us>                  idle line
+//   E F                     framing error reported by the UART
+static void replay(const char* capture) {
+    const char* p = capture;
+    while (*p) {
+        char type = *p++;
+        char* end;
+        switch (type) {
+            case 'B': {
+                uint32_t breakUs = strtoul(p, &end, 10);
+                uint32_t mabUs = strtoul(end, &end, 10);
+                uart->lineBreak(breakUs, mabUs);
+                p = end;
+                break;
+            }
+            case 'D': {
+                uint8_t byte;
+                while (true) {
+                    long v = strtol(p, &end, 16);
+                    if (end == p) break;
+                    byte = (uint8_t)v;
+                    uart->feed(&byte, 1);
+                    p = end;
+                    while (*p == ' ') p++;
+                    if (*p == '\n' || *p == '\0') break;
+                }
+                break;
+            }
+            case 'I':
+                uart->idle(strtol(p, &end, 10));
+                p = end;
+                break;
+            case 'E':
+                uart->reportError(UART_FRAME_ERROR);
+                break;
+            default:
+                break;
+        }
+        while (*p && *p != '\n') p++;
+        if (*p == '\n') p++;
+    }
+}
+
+// Synthetic capture in the replay format: a console sending 8 channels,
+// a framing error mid-frame and a frame with a short break
+static const char* capture8ch =
+    "B 120 12\n"
+    "D 00 ff 80 40 20 10 08 04 02\n"
+    "I 20000\n"
+    "B 120 12\n"
+    "D 00 fe 81 41\n"
+    "I 100\n"
+    "E F\n"
+    "D 21 11 09 05 03\n"
+    "I 20000\n"
+    "B 40 8\n"
+    "D 00 01 02 03 04 05 06 07 08\n"
+    "I 20000\n"
+    "B 120 12\n";
+
+// ===== Tests =====
+
+void setUp() {
+    uart = nullptr;
+}
+
+void tearDown() {}
+
+void test_full_frame() {
+    ESP32S3DMX dmx;
+    TEST_ASSERT_TRUE(dmx.begin(DMX_UART));
+    uart = HardwareSerial::port(DMX_UART);
+    
+    uint8_t channels[DMX_CHANNELS];
+    fillPattern(channels, DMX_CHANNELS, 3);
+    sendFrame(channels, DMX_CHANNELS);
+    TEST_ASSERT_EQUAL_UINT32(0, dmx.getFrameSequence());
+    endFrame();
+    
+    TEST_ASSERT_EQUAL_UINT32(1, dmx.getFrameSequence());
+    TEST_ASSERT_EQUAL_UINT16(DMX_PACKET_SIZE, dmx.getLastPacketSize());
+    for (uint16_t ch = 1; ch <= DMX_CHANNELS; ch++) {
+        TEST_ASSERT_EQUAL_UINT8(channels[ch - 1], dmx.read(ch));
+    }
+    
+    uint8_t frame[DMX_PACKET_SIZE];
+    uint16_t size = 0;
+    TEST_ASSERT_EQUAL_UINT32(1, dmx.readFrame(frame, &size));
+    TEST_ASSERT_EQUAL_UINT16(DMX_PACKET_SIZE, size);
+    TEST_ASSERT_EQUAL_UINT8(0, frame[0]);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(channels, &frame[1], DMX_CHANNELS);
+}
+
+void test_short_frame() {
+    ESP32S3DMX dmx;
+    TEST_ASSERT_TRUE(dmx.begin(DMX_UART));
+    uart = HardwareSerial::port(DMX_UART);
+    
+    uint8_t channels[24];
+    fillPattern(channels, 24, 9);
+    sendFrame(channels, 24);
+    endFrame();
+    
+    TEST_ASSERT_EQUAL_UINT16(25, dmx.getLastPacketSize());
+    TEST_ASSERT_EQUAL_UINT8(channels[23], dmx.read(24));
+    TEST_ASSERT_EQUAL_UINT8(0, dmx.read(25));
+    
+    uint8_t window[32];
+    TEST_ASSERT_EQUAL_UINT16(14, dmx.readChannels(window, 11, 32));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&channels[10], window, 14);
+    
+    DMXStats st;
+    dmx.getStats(st);
+    TEST_ASSERT_EQUAL_UINT32(1, st.slotHistogram[0]);
+}
+
+void test_missing_break_overrun() {
+    ESP32S3DMX dmx;
+    TEST_ASSERT_TRUE(dmx.begin(DMX_UART));
+    uart = HardwareSerial::port(DMX_UART);
+    
+    uint8_t first[DMX_CHANNELS];
+    uint8_t second[DMX_CHANNELS];
+    fillPattern(first, DMX_CHANNELS, 1);
+    fillPattern(second, DMX_CHANNELS, 100);
+    
+    // Two frames back to back without a break in between
+    sendFrame(first, DMX_CHANNELS);
+    uint8_t startCode = 0;
+    uart->feed(&startCode, 1);
+    uart->feed(second, DMX_CHANNELS);
+    endFrame();
+    
+    TEST_ASSERT_EQUAL_UINT32(1, dmx.getFrameSequence());
+    TEST_ASSERT_EQUAL_UINT16(DMX_PACKET_SIZE, dmx.getLastPacketSize());
+    TEST_ASSERT_EQUAL_UINT8(first[0], dmx.read(1));
+    TEST_ASSERT_EQUAL_UINT8(first[511], dmx.read(512));
+    
+    DMXStats st;
+    dmx.getStats(st);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, st.overruns);
+    
+    // The excess must not leak into the next frame
+    uart->feed(second, 10);
+    endFrame();
+    sendFrame(second, DMX_CHANNELS);
+    endFrame();
+    TEST_ASSERT_EQUAL_UINT8(second[0], dmx.read(1));
+    TEST_ASSERT_EQUAL_UINT8(second[511], dmx.read(512));
+}
+
+void test_garbage_then_valid() {
+    ESP32S3DMX dmx;
+    TEST_ASSERT_TRUE(dmx.begin(DMX_UART));
+    uart = HardwareSerial::port(DMX_UART);
+    
+    uint8_t garbage[300];
+    srand(42);
+    for (uint16_t i = 0; i < sizeof(garbage); i++) {
+        garbage[i] = (uint8_t)(rand() | 1);  // never a valid start code
+    }
+    uart->feed(garbage, sizeof(garbage));
+    
+    uint8_t channels[DMX_CHANNELS];
+    fillPattern(channels, DMX_CHANNELS, 77);
+    sendFrame(channels, DMX_CHANNELS);
+    endFrame();
+    
+    // Garbage is published as a frame with a bad start code, then replaced
+    TEST_ASSERT_EQUAL_UINT32(2, dmx.getFrameSequence());
+    DMXStats st;
+    dmx.getStats(st);
+    TEST_ASSERT_EQUAL_UINT32(1, st.nonZeroStartCodes);
+    for (uint16_t ch = 1; ch <= DMX_CHANNELS; ch++) {
+        TEST_ASSERT_EQUAL_UINT8(channels[ch - 1], dmx.read(ch));
+    }
+}
+
+void test_replay_capture() {
+    ESP32S3DMX dmx;
+    TEST_ASSERT_TRUE(dmx.begin(DMX_UART));
+    uart = HardwareSerial::port(DMX_UART);
+    
+    uint32_t frames = 0;
+    dmx.onFrame([&frames](uint32_t, uint16_t, int64_t) { frames++; });
+    replay(capture8ch);
+    
+    TEST_ASSERT_EQUAL_UINT32(3, frames);
+    TEST_ASSERT_EQUAL_UINT16(9, dmx.getLastPacketSize());
+    TEST_ASSERT_EQUAL_UINT8(0x01, dmx.read(1));
+    TEST_ASSERT_EQUAL_UINT8(0x08, dmx.read(8));
+    
+    DMXStats st;
+    dmx.getStats(st);
+    TEST_ASSERT_EQUAL_UINT32(1, st.framingErrors);
+    TEST_ASSERT_EQUAL_UINT32(1, dmx.getErrorCount());
+}
+
+void test_break_frame_error_not_counted() {
+    ESP32S3DMX dmx;
+    TEST_ASSERT_TRUE(dmx.begin(DMX_UART));
+    uart = HardwareSerial::port(DMX_UART);
+    
+    // every break raises a frame error on this UART, a clean line has none
+    uint8_t frame[9] = {0x00, 1, 2, 3, 4, 5, 6, 7, 8};
+    for (int i = 0; i < 5; i++) {
+        uart->lineBreak(120, 12);
+        uart->feed(frame, sizeof(frame));
+        uart->idle(20000);
+    }
+    uart->lineBreak(120, 12);
+    
+    DMXStats st;
+    dmx.getStats(st);
+    TEST_ASSERT_EQUAL_UINT32(0, st.framingErrors);
+    TEST_ASSERT_EQUAL_UINT32(0, dmx.getErrorCount());
+}
+
+void test_short_break() {
+    ESP32S3DMX dmx;
+    TEST_ASSERT_TRUE(dmx.begin(DMX_UART));
+    uart = HardwareSerial::port(DMX_UART);
+    
+    uart->lineBreak(120, 12);
+    uart->lineBreak(40, 8, false);  // glitch right after a break
+    
+    DMXStats st;
+    dmx.getStats(st);
+    TEST_ASSERT_EQUAL_UINT32(1, st.shortBreakIntervals);
+}
+
+void test_44hz_stream_timing() {
+    ESP32S3DMX dmx;
+    TEST_ASSERT_TRUE(dmx.begin(DMX_UART));
+    uart = HardwareSerial::port(DMX_UART);
+    
+    // Minimum break and MAB leave room for 44 Hz with all 512 channels
+    uint8_t channels[DMX_CHANNELS];
+    uint8_t startCode = 0;
+    for (int i = 0; i < 200; i++) {
+        int64_t start = esp_timer_get_time();
+        fillPattern(channels, DMX_CHANNELS, (uint8_t)i);
+        uart->lineBreak(DMX_BREAK_MIN, DMX_MAB_MIN);
+        uart->feed(&startCode, 1);
+        uart->feed(channels, DMX_CHANNELS);
+        uart->idle(FRAME_44HZ_US - (esp_timer_get_time() - start));
+    }
+    uart->lineBreak(DMX_BREAK_MIN, DMX_MAB_MIN);
+    
+    DMXStats st;
+    dmx.getStats(st);
+    TEST_ASSERT_EQUAL_UINT32(199, st.frames);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 44.0f, dmx.getPacketRate());
+    TEST_ASSERT_UINT32_WITHIN(50, FRAME_44HZ_US, st.intervalMinUs);
+    TEST_ASSERT_UINT32_WITHIN(50, FRAME_44HZ_US, st.intervalMaxUs);
+    TEST_ASSERT_EQUAL_UINT32(199, st.jitterHistogram[0]);
+    TEST_ASSERT_EQUAL_UINT32(200, st.slotHistogram[DMX_SLOT_BUCKETS - 1]);
+    
+    // A full frame needs a handful of callbacks at the default FIFO threshold
+    TEST_ASSERT_LESS_OR_EQUAL_UINT16(6, dmx.getCallbacksPerFrame());
+}
+
+void test_two_universes() {
+    ESP32S3DMX universeA;
+    ESP32S3DMXPort<1, 16, 17, 18> universeB;
+    ESP32S3DMX duplicate;
+    TEST_ASSERT_TRUE(universeA.begin(2));
+    TEST_ASSERT_TRUE(universeB.begin());
+    TEST_ASSERT_FALSE(duplicate.begin(1));
+    
+    uint8_t a[16];
+    uint8_t b[16];
+    fillPattern(a, 16, 10);
+    fillPattern(b, 16, 200);
+    
+    uart = HardwareSerial::port(2);
+    sendFrame(a, 16);
+    endFrame();
+    uart = HardwareSerial::port(1);
+    sendFrame(b, 16);
+    endFrame();
+    
+    TEST_ASSERT_EQUAL_UINT8(a[5], universeA.read(6));
+    TEST_ASSERT_EQUAL_UINT8(b[5], universeB.read(6));
+}
+
+void test_max_rate_throughput() {
+    ESP32S3DMX dmx;
+    TEST_ASSERT_TRUE(dmx.begin(DMX_UART));
+    uart = HardwareSerial::port(DMX_UART);
+    
+    const int frames = 20000;
+    uint8_t channels[DMX_CHANNELS];
+    uint32_t bad = 0;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        channels[0] = (uint8_t)i;
+        uart->lineBreak(92, 12);
+        uint8_t startCode = 0;
+        uart->feed(&startCode, 1);
+        uart->feed(channels, DMX_CHANNELS);
+        if (i > 0 && dmx.read(1) != (uint8_t)(i - 1)) {
+            bad++;
+        }
+    }
+    endFrame();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    TEST_ASSERT_EQUAL_UINT32(0, bad);
+    TEST_ASSERT_EQUAL_UINT32(frames, dmx.getFrameSequence());
+    
+    char msg[160];
+    snprintf(msg, sizeof(msg),
+             "max-rate: %d frames in %.3f s, %.0f frames/s, %.1f MB/s, %u callbacks/frame",
+             frames, elapsed, frames / elapsed, frames * (double)DMX_PACKET_SIZE / elapsed / 1e6,
+             dmx.getCallbacksPerFrame());
+    TEST_MESSAGE(msg);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_frame);
+    RUN_TEST(test_short_frame);
+    RUN_TEST(test_missing_break_overrun);
+    RUN_TEST(test_garbage_then_valid);
+    RUN_TEST(test_replay_capture);
+    RUN_TEST(test_break_frame_error_not_counted);
+    RUN_TEST(test_short_break);
+    RUN_TEST(test_44hz_stream_timing);
+    RUN_TEST(test_two_universes);
+    RUN_TEST(test_max_rate_throughput);
+    return UNITY_END();
+}
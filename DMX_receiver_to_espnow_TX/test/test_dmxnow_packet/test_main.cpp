@@ -0,0 +1,401 @@
+/*
+  DMXNowPacket wire format tests
+
+  Encodes frames the way the bridge does and checks that the receiver-side
+  decoder accepts them and rejects truncated, foreign and out-of-range
+  packets, then reassembles fragmented universes, raw and compressed.
+
+  Run with: pio test -e native -v
+*/
+
+#include <unity.h>
+#include <string.h>
+#include "DMXNowPacket.h"
+
+static DMXNowFrame frame;
+static DMXNowFrame fragments[DMXNOW_MAX_FRAGMENTS];
+static uint8_t universe[DMXNOW_UNIVERSE_SLOTS];
+
+static size_t sizes[DMXNOW_MAX_FRAGMENTS];
+static uint8_t previous[DMXNOW_UNIVERSE_SLOTS];
+
+// Split the universe the way forwardDMX() does, optionally compressed
+// against the previous call's universe
+static uint8_t encodeUniverse(uint16_t sequence, bool compress, bool keyframe) {
+    uint8_t count = (DMXNOW_UNIVERSE_SLOTS + DMXNOW_MAX_PAYLOAD - 1) / DMXNOW_MAX_PAYLOAD;
+    for (uint8_t f = 0; f < count; f++) {
+        uint16_t offset = f * DMXNOW_MAX_PAYLOAD;
+        uint16_t remaining = DMXNOW_UNIVERSE_SLOTS - offset;
+        uint16_t length = remaining < DMXNOW_MAX_PAYLOAD ? remaining : (uint16_t)DMXNOW_MAX_PAYLOAD;
+        uint8_t flags = 0;
+        uint16_t size = 0;
+        if (compress) {
+            size = dmxNowEncodePayload(fragments[f].payload, universe + offset,
+                                       keyframe ? nullptr : previous + offset, length, flags);
+        } else {
+            memcpy(fragments[f].payload, universe + offset, length);
+        }
+        sizes[f] = dmxNowFinish(fragments[f], 0, sequence, 1 + offset, length, f, count, flags, size);
+    }
+    memcpy(previous, universe, DMXNOW_UNIVERSE_SLOTS);
+    return count;
+}
+
+static uint8_t fragmentUniverse(uint16_t sequence, uint8_t seed) {
+    for (int i = 0; i < DMXNOW_UNIVERSE_SLOTS; i++) universe[i] = (uint8_t)(i * 5 + seed);
+    return encodeUniverse(sequence, false, true);
+}
+
+static DMXNowAssembler::Result feed(DMXNowAssembler &assembler, uint8_t f, uint32_t nowMs = 0) {
+    const uint8_t *payload;
+    uint16_t size;
+    const DMXNowHeader *header = dmxNowDecode((const uint8_t *)&fragments[f], sizes[f], &payload, &size);
+    TEST_ASSERT_NOT_NULL(header);
+    return assembler.add(*header, payload, size, nowMs);
+}
+
+void setUp() {
+    memset(&frame, 0, sizeof(frame));
+}
+
+void tearDown() {}
+
+void test_header_layout() {
+    TEST_ASSERT_EQUAL(13, DMXNOW_HEADER_SIZE);
+    TEST_ASSERT_EQUAL(3, DMXNOW_MAX_FRAGMENTS);
+    TEST_ASSERT_EQUAL(DMXNOW_MAX_PACKET, sizeof(DMXNowFrame));
+}
+
+void test_telemetry() {
+    TEST_ASSERT_EQUAL(24, sizeof(DMXNowTelemetry));
+
+    DMXNowTelemetry report = {};
+    report.magic = DMXNOW_TELEMETRY_MAGIC;
+    report.version = DMXNOW_VERSION;
+    report.rssi = -67;
+    const uint8_t *data = (const uint8_t *)&report;
+    const DMXNowTelemetry *decoded = dmxNowDecodeTelemetry(data, sizeof(report));
+    TEST_ASSERT_NOT_NULL(decoded);
+    TEST_ASSERT_EQUAL(-67, decoded->rssi);
+    TEST_ASSERT_NULL(dmxNowDecodeTelemetry(data, sizeof(report) - 1));
+
+    // DMX packets and link reports can't be mistaken for each other
+    const uint8_t *payload;
+    uint16_t payloadSize;
+    TEST_ASSERT_NULL(dmxNowDecode(data, sizeof(report), &payload, &payloadSize));
+    size_t size = dmxNowFinish(frame, 0, 0, 1, 64);
+    TEST_ASSERT_NULL(dmxNowDecodeTelemetry((const uint8_t *)&frame, size));
+}
+
+void test_round_trip() {
+    for (int i = 0; i < 49; i++) frame.payload[i] = i * 3;
+    size_t size = dmxNowFinish(frame, 1, 0x1234, 100, 49, 0, 1, 0, 0, 7);
+    TEST_ASSERT_EQUAL(DMXNOW_HEADER_SIZE + 49, size);
+
+    const uint8_t *payload = nullptr;
+    uint16_t payloadSize = 0;
+    const DMXNowHeader *header = dmxNowDecode((const uint8_t *)&frame, size, &payload, &payloadSize);
+    TEST_ASSERT_NOT_NULL(header);
+    TEST_ASSERT_EQUAL(7, header->group);
+    TEST_ASSERT_EQUAL(1, header->universe);
+    TEST_ASSERT_EQUAL(0x1234, header->sequence);
+    TEST_ASSERT_EQUAL(100, header->start);
+    TEST_ASSERT_EQUAL(49, header->length);
+    TEST_ASSERT_EQUAL_PTR(frame.payload, payload);
+    TEST_ASSERT_EQUAL(49, payloadSize);
+}
+
+void test_length_clamped_to_packet() {
+    size_t size = dmxNowFinish(frame, 0, 0, 1, 300);
+    TEST_ASSERT_EQUAL(DMXNOW_MAX_PACKET, size);
+    TEST_ASSERT_EQUAL(DMXNOW_MAX_PAYLOAD, frame.header.length);
+}
+
+void test_rejects_malformed() {
+    const uint8_t *payload;
+    uint16_t payloadSize;
+    size_t size = dmxNowFinish(frame, 0, 0, 1, 24);
+    const uint8_t *data = (const uint8_t *)&frame;
+
+    // shorter than the header or the announced payload
+    TEST_ASSERT_NULL(dmxNowDecode(data, DMXNOW_HEADER_SIZE - 1, &payload, &payloadSize));
+    TEST_ASSERT_NULL(dmxNowDecode(data, size - 1, &payload, &payloadSize));
+
+    // the pre-header 51 byte struct the bridge used to send
+    uint8_t legacy[51] = { 0 };
+    TEST_ASSERT_NULL(dmxNowDecode(legacy, sizeof(legacy), &payload, &payloadSize));
+
+    frame.header.version = DMXNOW_VERSION + 1;
+    TEST_ASSERT_NULL(dmxNowDecode(data, size, &payload, &payloadSize));
+
+    // unknown or conflicting encodings
+    frame.header.version = DMXNOW_VERSION;
+    frame.header.flags = 0x80;
+    TEST_ASSERT_NULL(dmxNowDecode(data, size, &payload, &payloadSize));
+    frame.header.flags = DMXNOW_FLAG_RLE | DMXNOW_FLAG_DELTA;
+    TEST_ASSERT_NULL(dmxNowDecode(data, size, &payload, &payloadSize));
+}
+
+void test_rejects_slots_outside_universe() {
+    const uint8_t *payload;
+    uint16_t payloadSize;
+    const uint8_t *data = (const uint8_t *)&frame;
+
+    size_t size = dmxNowFinish(frame, 0, 0, 0, 4);
+    TEST_ASSERT_NULL(dmxNowDecode(data, size, &payload, &payloadSize));
+
+    size = dmxNowFinish(frame, 0, 0, 500, 13);
+    TEST_ASSERT_NOT_NULL(dmxNowDecode(data, size, &payload, &payloadSize)); // slots 500-512
+    size = dmxNowFinish(frame, 0, 0, 500, 14);
+    TEST_ASSERT_NULL(dmxNowDecode(data, size, &payload, &payloadSize));
+}
+
+void test_rejects_bad_fragment_index() {
+    const uint8_t *payload;
+    uint16_t payloadSize;
+    const uint8_t *data = (const uint8_t *)&frame;
+
+    size_t size = dmxNowFinish(frame, 0, 0, 1, 4, 3, 3);
+    TEST_ASSERT_NULL(dmxNowDecode(data, size, &payload, &payloadSize));
+    size = dmxNowFinish(frame, 0, 0, 1, 4, 0, DMXNOW_MAX_FRAGMENTS + 1);
+    TEST_ASSERT_NULL(dmxNowDecode(data, size, &payload, &payloadSize));
+}
+
+void test_reassemble_full_universe() {
+    DMXNowAssembler assembler;
+    TEST_ASSERT_EQUAL(3, fragmentUniverse(7, 1));
+
+    // arrival order doesn't matter
+    TEST_ASSERT_EQUAL(DMXNowAssembler::FRAGMENT_STORED, feed(assembler, 2));
+    TEST_ASSERT_EQUAL(DMXNowAssembler::FRAGMENT_STORED, feed(assembler, 0));
+    TEST_ASSERT_EQUAL(DMXNowAssembler::FRAME_COMPLETE, feed(assembler, 1));
+    TEST_ASSERT_EQUAL_MEMORY(universe, assembler.slots(), DMXNOW_UNIVERSE_SLOTS);
+    TEST_ASSERT_EQUAL(1, assembler.framesComplete);
+
+    // a duplicate of a complete frame is rejected
+    TEST_ASSERT_EQUAL(DMXNowAssembler::FRAGMENT_REJECTED, feed(assembler, 1));
+    TEST_ASSERT_EQUAL(1, assembler.lateFragments);
+}
+
+void test_superseded_frame_policy() {
+    DMXNowAssembler assembler;
+    fragmentUniverse(1, 0);
+    feed(assembler, 0);
+    feed(assembler, 1);
+
+    // fragment 2 of frame 1 never arrives
+    fragmentUniverse(2, 9);
+    TEST_ASSERT_EQUAL(DMXNowAssembler::FRAGMENT_STORED, feed(assembler, 0));
+    TEST_ASSERT_EQUAL(1, assembler.framesPartial);
+
+    assembler.applyPartial = true;
+    fragmentUniverse(3, 4);
+    TEST_ASSERT_EQUAL(DMXNowAssembler::FRAME_PARTIAL, feed(assembler, 1));
+    TEST_ASSERT_EQUAL(2, assembler.framesPartial);
+    TEST_ASSERT_EQUAL(0, assembler.framesComplete);
+
+    // a fragment of an older frame is late
+    fragmentUniverse(2, 9);
+    TEST_ASSERT_EQUAL(DMXNowAssembler::FRAGMENT_REJECTED, feed(assembler, 2));
+}
+
+void test_reassembly_timeout() {
+    DMXNowAssembler assembler;
+    fragmentUniverse(5, 0);
+    feed(assembler, 0, 1000);
+
+    TEST_ASSERT_FALSE(assembler.expire(1000 + DMXNOW_REASSEMBLY_TIMEOUT_MS - 1));
+    TEST_ASSERT_FALSE(assembler.expire(1000 + DMXNOW_REASSEMBLY_TIMEOUT_MS)); // dropped by default
+    TEST_ASSERT_EQUAL(1, assembler.timeouts);
+
+    // the rest of the timed out frame is rejected, the next frame is fine
+    TEST_ASSERT_EQUAL(DMXNowAssembler::FRAGMENT_REJECTED, feed(assembler, 1, 1100));
+    uint8_t count = fragmentUniverse(6, 0);
+    for (uint8_t f = 0; f < count; f++) feed(assembler, f, 1100);
+    TEST_ASSERT_EQUAL(1, assembler.framesComplete);
+    TEST_ASSERT_EQUAL(0, assembler.framesPartial);
+}
+
+void test_bridge_restart() {
+    DMXNowAssembler assembler;
+    uint8_t count = fragmentUniverse(5000, 0);
+    for (uint8_t f = 0; f < count; f++) feed(assembler, f);
+
+    // sequence jumps back to 0 after a bridge reboot
+    count = fragmentUniverse(0, 3);
+    for (uint8_t f = 0; f < count; f++) feed(assembler, f);
+    TEST_ASSERT_EQUAL(2, assembler.framesComplete);
+    TEST_ASSERT_EQUAL_MEMORY(universe, assembler.slots(), DMXNOW_UNIVERSE_SLOTS);
+    TEST_ASSERT_EQUAL(0, assembler.framesLost);
+}
+
+void test_sequence_gap_counts_lost_frames() {
+    DMXNowAssembler assembler;
+    uint8_t count = fragmentUniverse(65534, 0);
+    for (uint8_t f = 0; f < count; f++) feed(assembler, f);
+
+    // 65535 and 0 never arrive, the counter wraps
+    count = fragmentUniverse(1, 0);
+    for (uint8_t f = 0; f < count; f++) feed(assembler, f);
+    TEST_ASSERT_EQUAL(2, assembler.framesLost);
+    TEST_ASSERT_EQUAL(0, assembler.framesPartial);
+}
+
+void test_rle_round_trip() {
+    uint8_t slots[DMXNOW_MAX_PAYLOAD];
+    uint8_t out[DMXNOW_MAX_PAYLOAD];
+    uint8_t decoded[DMXNOW_MAX_PAYLOAD];
+
+    // dimmer packs: runs of parked fixtures between a few moving values
+    memset(slots, 0, sizeof(slots));
+    memset(slots + 40, 255, 150);
+    slots[7] = 12;
+    slots[8] = 13;
+    int size = dmxNowEncodeRLE(slots, sizeof(slots), out, sizeof(out));
+    TEST_ASSERT_TRUE(size > 0 && size < 16);
+    TEST_ASSERT_TRUE(dmxNowDecodeRLE(out, size, decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL_MEMORY(slots, decoded, sizeof(slots));
+
+    // noise does not fit in fewer bytes than it has slots
+    for (int i = 0; i < (int)DMXNOW_MAX_PAYLOAD; i++) slots[i] = (uint8_t)(i * 7);
+    TEST_ASSERT_EQUAL(-1, dmxNowEncodeRLE(slots, sizeof(slots), out, sizeof(slots) - 1));
+
+    // truncated or overlong payloads are refused
+    size = dmxNowEncodeRLE(slots, 10, out, sizeof(out));
+    TEST_ASSERT_FALSE(dmxNowDecodeRLE(out, size - 1, decoded, 10));
+    TEST_ASSERT_FALSE(dmxNowDecodeRLE(out, size, decoded, 9));
+    TEST_ASSERT_FALSE(dmxNowDecodeRLE(out, size, decoded, 11));
+}
+
+void test_delta_round_trip() {
+    uint8_t base[DMXNOW_MAX_PAYLOAD];
+    uint8_t slots[DMXNOW_MAX_PAYLOAD];
+    uint8_t out[DMXNOW_MAX_PAYLOAD];
+    for (int i = 0; i < (int)DMXNOW_MAX_PAYLOAD; i++) base[i] = (uint8_t)(i * 7);
+    memcpy(slots, base, sizeof(slots));
+
+    TEST_ASSERT_EQUAL(0, dmxNowEncodeDelta(slots, base, sizeof(slots), out, sizeof(out)));
+
+    // one fader and an RGB fixture past the 255 slot skip limit of a pair
+    slots[3]++;
+    slots[200]++;
+    slots[202]++;
+    int size = dmxNowEncodeDelta(slots, base, sizeof(slots), out, sizeof(out));
+    TEST_ASSERT_EQUAL(2 + 1 + 2 + 3, size);
+
+    uint8_t decoded[DMXNOW_MAX_PAYLOAD];
+    memcpy(decoded, base, sizeof(decoded));
+    TEST_ASSERT_TRUE(dmxNowDecodeDelta(out, size, decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL_MEMORY(slots, decoded, sizeof(slots));
+    TEST_ASSERT_FALSE(dmxNowDecodeDelta(out, size, decoded, 200));
+}
+
+void test_compressed_stream() {
+    DMXNowAssembler assembler;
+    for (int i = 0; i < DMXNOW_UNIVERSE_SLOTS; i++) universe[i] = i < 96 ? (uint8_t)i : 0;
+
+    // keyframe: RLE, no delta
+    uint8_t count = encodeUniverse(1, true, true);
+    size_t total = 0;
+    for (uint8_t f = 0; f < count; f++) {
+        TEST_ASSERT_FALSE(fragments[f].header.flags & DMXNOW_FLAG_DELTA);
+        total += sizes[f];
+        feed(assembler, f);
+    }
+    TEST_ASSERT_TRUE(total < DMXNOW_UNIVERSE_SLOTS / 2);
+    TEST_ASSERT_EQUAL_MEMORY(universe, assembler.slots(), DMXNOW_UNIVERSE_SLOTS);
+
+    // a few faders move: deltas on top of the keyframe
+    universe[10] = 200;
+    universe[300] = 1;
+    count = encodeUniverse(2, true, false);
+    TEST_ASSERT_EQUAL(DMXNOW_FLAG_DELTA, fragments[0].header.flags);
+    TEST_ASSERT_EQUAL(DMXNOW_HEADER_SIZE + 3, sizes[0]);
+    for (uint8_t f = 0; f < count; f++) feed(assembler, f);
+    TEST_ASSERT_EQUAL(2, assembler.framesComplete);
+    TEST_ASSERT_EQUAL_MEMORY(universe, assembler.slots(), DMXNOW_UNIVERSE_SLOTS);
+}
+
+void test_delta_waits_for_keyframe() {
+    DMXNowAssembler assembler;
+    memset(universe, 0, sizeof(universe));
+    uint8_t count = encodeUniverse(1, true, true);
+    for (uint8_t f = 0; f < count; f++) feed(assembler, f);
+
+    // frame 2 loses a fragment, the deltas of frame 3 have no base
+    universe[5] = 50;
+    encodeUniverse(2, true, false);
+    feed(assembler, 0);
+    universe[6] = 60;
+    encodeUniverse(3, true, false);
+    TEST_ASSERT_EQUAL(DMXNowAssembler::FRAGMENT_REJECTED, feed(assembler, 0));
+    TEST_ASSERT_EQUAL(1, assembler.missingBase);
+
+    // the next keyframe resyncs
+    count = encodeUniverse(4, true, true);
+    for (uint8_t f = 0; f < count; f++) feed(assembler, f);
+    TEST_ASSERT_EQUAL(2, assembler.framesComplete);
+    TEST_ASSERT_EQUAL_MEMORY(universe, assembler.slots(), DMXNOW_UNIVERSE_SLOTS);
+}
+
+void test_malformed_payload_keeps_slots() {
+    DMXNowAssembler assembler;
+    for (int i = 0; i < DMXNOW_UNIVERSE_SLOTS; i++) universe[i] = (uint8_t)i;
+    uint8_t count = encodeUniverse(1, true, true);
+    for (uint8_t f = 0; f < count; f++) feed(assembler, f);
+
+    // a delta that runs past its slot count after patching the first slots
+    universe[0] = 99;
+    universe[1] = 98;
+    encodeUniverse(2, true, false);
+    TEST_ASSERT_EQUAL(DMXNOW_FLAG_DELTA, fragments[0].header.flags);
+    fragments[0].payload[sizes[0] - DMXNOW_HEADER_SIZE] = 0xFF;
+    fragments[0].payload[sizes[0] - DMXNOW_HEADER_SIZE + 1] = 0xFF;
+    sizes[0] += 2;
+    TEST_ASSERT_EQUAL(DMXNowAssembler::FRAGMENT_REJECTED, feed(assembler, 0));
+    TEST_ASSERT_EQUAL(1, assembler.decodeErrors);
+    TEST_ASSERT_EQUAL(0, assembler.slots()[0]);
+    TEST_ASSERT_EQUAL(1, assembler.slots()[1]);
+}
+
+void test_reset_drops_delta_base() {
+    DMXNowAssembler assembler;
+    memset(universe, 7, sizeof(universe));
+    uint8_t count = encodeUniverse(1, true, true);
+    for (uint8_t f = 0; f < count; f++) feed(assembler, f);
+
+    // another universe follows with its own sequence, deltas wait for its keyframe
+    assembler.reset();
+    TEST_ASSERT_EQUAL(0, assembler.slots()[0]);
+    universe[0] = 8;
+    encodeUniverse(2, true, false);
+    TEST_ASSERT_EQUAL(DMXNowAssembler::FRAGMENT_REJECTED, feed(assembler, 0));
+    TEST_ASSERT_EQUAL(1, assembler.missingBase);
+    count = encodeUniverse(3, true, true);
+    for (uint8_t f = 0; f < count; f++) feed(assembler, f);
+    TEST_ASSERT_EQUAL(2, assembler.framesComplete);
+    TEST_ASSERT_EQUAL_MEMORY(universe, assembler.slots(), DMXNOW_UNIVERSE_SLOTS);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_header_layout);
+    RUN_TEST(test_telemetry);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_length_clamped_to_packet);
+    RUN_TEST(test_rejects_malformed);
+    RUN_TEST(test_rejects_slots_outside_universe);
+    RUN_TEST(test_rejects_bad_fragment_index);
+    RUN_TEST(test_reassemble_full_universe);
+    RUN_TEST(test_superseded_frame_policy);
+    RUN_TEST(test_reassembly_timeout);
+    RUN_TEST(test_bridge_restart);
+    RUN_TEST(test_sequence_gap_counts_lost_frames);
+    RUN_TEST(test_rle_round_trip);
+    RUN_TEST(test_delta_round_trip);
+    RUN_TEST(test_compressed_stream);
+    RUN_TEST(test_delta_waits_for_keyframe);
+    RUN_TEST(test_malformed_payload_keeps_slots);
+    RUN_TEST(test_reset_drops_delta_base);
+    return UNITY_END();
+}
@@ -3,6 +3,8 @@
 #include <esp_now.h>
 #include <WiFi.h>
 #include <esp_wifi.h>
+#include <Preferences.h>
+#include "DMXNowPacket.h"
 
 // modes
 // 0-9: full strip control
@@ -16,9 +18,12 @@
 //   uint8_t white;
 // };// dmxPacket;
 
-struct DMXDataPacket {
+// DMX window received from the bridge, see DMXNowPacket.h for the wire format
+struct DMXWindow {
   uint8_t data[49]; // 1+(6*8)=49 channels there is 1 mode selection, and then max of 8 segments and every segment has 6 channels (start led, end led, r, g, b, w)
-  uint8_t count;
+  uint16_t start;   // DMX slot of data[0] at the bridge
+  uint16_t count;   // bytes of data filled by the last frame
+  uint16_t sequence;
 };
 
 struct ledStripLight {
@@ -28,6 +33,28 @@ struct ledStripLight {
   uint8_t white;
 };
 
+// which slots of the bridge broadcast belong to this light and how they are
+// rendered, kept in NVS so every light runs the same firmware
+struct ReceiverConfig {
+  uint8_t group;    // ESP-NOW group of the bridge to follow
+  uint8_t universe; // bridge DMX input to listen to
+  uint16_t address; // DMX slot of this light's mode channel, 0 = first slot the bridge forwards
+  uint16_t smoothingMs; // fade from one received frame to the next over this long, 0 = off
+};
+
+// link quality since the last report to the bridge, guarded by dmxMux
+struct LinkMonitor {
+  uint8_t bridge[6];       // sender of the last accepted packet
+  bool bridgeKnown;
+  uint32_t lastArrivalUs;  // first fragment of the last frame sent by the bridge
+  uint32_t lastIntervalUs; // 0 after a gap in the stream
+  uint32_t intervalUs;     // moving average time between frames while the bridge sends periodically
+  uint32_t jitterUs;       // moving average change of that interval (RFC 3550)
+  bool jitterSeeded;       // jitterUs holds a sample of the current cadence
+  int32_t rssiSum;         // RSSI of the bridge's packets, dBm
+  uint16_t rssiCount;
+};
+
 struct Segment {
   uint16_t startLed;
   uint16_t endLed;
@@ -37,14 +64,22 @@ struct Segment {
   uint8_t white;
 };
 
-DMXDataPacket dmx; 
+DMXWindow dmx; // last applied frame, guarded by dmxMux
+DMXNowAssembler assembler; // fragments -> frames, guarded by dmxMux
+uint32_t decodeUs = 0;     // time to decode and store the last fragment, guarded by dmxMux
+uint32_t maxDecodeUs = 0;  // worst decode time since boot
+portMUX_TYPE dmxMux = portMUX_INITIALIZER_UNLOCKED;
 ledStripLight ledStrip;
- 
-uint8_t broadcastAddress[] = {0x32, 0xAE, 0xA4, 0x07, 0x0D, 0x66};
 
 #define LED_PIN 4
 #define NUM_LEDS 80
 #define NUM_SEGMENTS 8
+#define DMX_UNIVERSE_DEFAULT 0 // bridge DMX input this light listens to
+#define DMX_ADDRESS_DEFAULT 0  // 0 = follow the start of the forwarded window
+#define APPLY_PARTIAL_FRAMES false // show incomplete frames instead of dropping them
+#define TELEMETRY_INTERVAL_MS 3000 // how often the link report is sent to the bridge
+#define SMOOTHING_DEFAULT_MS 25    // about one DMX frame at 40 Hz
+#define STRIP_FRAME_US (NUM_LEDS * 40 + 300) // 32 bits of 1.25 us per RGBW LED plus latch
 
 // NeoPixelBus<NeoGrbwFeature, NeoEsp32Rmt0800KbpsMethod> strip(NUM_LEDS, LED_PIN);
 // NeoPixelBus<NeoGrbwFeature, NeoEsp32BitBang800KbpsMethod> strip(NUM_LEDS, LED_PIN);
@@ -56,13 +91,39 @@ RgbwColor WW_Color(0, 255, 0, 0);
 // Define segments (example: 4 segments)
 Segment segments[NUM_SEGMENTS];
 
+ReceiverConfig rxConfig = { DMXNOW_GROUP_DEFAULT, DMX_UNIVERSE_DEFAULT, DMX_ADDRESS_DEFAULT, SMOOTHING_DEFAULT_MS };
+Preferences prefs;
+
+LinkMonitor linkStats;
+int8_t sniffedRssi = 0;    // RSSI of the last ESP-NOW frame seen by the radio
+uint8_t sniffedMac[6];     // its transmitter
+uint32_t renderCount = 0;  // render passes since boot
+uint32_t showCount = 0;    // Show() calls since boot, only made when pixels changed
+uint32_t renderUsSum = 0;  // render time since the last stats print
+uint32_t renderUsMax = 0;
+
+// temporal interpolation, loop() only
+DMXWindow target;                       // latest frame received
+DMXWindow shown;                        // frame on the strip, between fadeFrom and target
+uint8_t fadeFrom[sizeof(shown.data)];   // what was shown when target arrived
+uint32_t targetUs = 0;                  // micros() when target arrived
+
 // functions
 void setSegments();
-void updateSegmentsFromDMX();
+void updateSegmentsFromDMX(const DMXWindow &frame);
+void applyAssembledFrame();
+void trackArrival(uint32_t arrivalUs);
 void breathe(RgbwColor baseColor, byte period = 128, byte lowValue = 0, byte highValue = 255);
 bool startupChase(RgbwColor color, unsigned long speedMs = 100);
 void setLightOnStrip(RgbwColor color);
 void onDataRecv(const uint8_t* mac, const uint8_t *incomingData, int len);
+void loadReceiverConfig();
+void handleSerialConfig();
+void onPromiscuousRx(void *buf, wifi_promiscuous_pkt_type_t type);
+void sendTelemetry(unsigned long now);
+void interpolateFrame(uint32_t elapsedUs);
+bool fillSpan(uint16_t first, uint16_t last, RgbwColor color);
+void showIfChanged(bool changed);
 
 // Breathing state variables
 float brightness = 0.0;   // 0.0 - 1.0
@@ -79,19 +140,30 @@ void setup() {
   strip.Begin();
   strip.Show();
 
+  Serial.setTimeout(100);
+
   WiFi.mode(WIFI_STA);
-  
-  esp_err_t err = esp_wifi_set_mac(WIFI_IF_STA, &broadcastAddress[0]);
-  if (err == ESP_OK) {
-    Serial.println("setting MAC address SUCCESS");
-  }
+
+  // the bridge broadcasts, so the factory MAC is kept and only the
+  // configured slots are picked out of each frame
+  loadReceiverConfig();
+  Serial.printf("Light %s: group=%u universe=%u address=%u smoothing=%u ms\n", WiFi.macAddress().c_str(),
+                rxConfig.group, rxConfig.universe, rxConfig.address, rxConfig.smoothingMs);
 
   if (esp_now_init() != ESP_OK) {
     Serial.println("Error initializing ESP-NOW");
     return;
   }
+  assembler.applyPartial = APPLY_PARTIAL_FRAMES;
   esp_now_register_recv_cb(esp_now_recv_cb_t(onDataRecv));
 
+  // the receive callback carries no RSSI, take it from the radio's
+  // management frames instead (ESP-NOW packets are action frames)
+  wifi_promiscuous_filter_t filter = { .filter_mask = WIFI_PROMIS_FILTER_MASK_MGMT };
+  esp_wifi_set_promiscuous_filter(&filter);
+  esp_wifi_set_promiscuous_rx_cb(onPromiscuousRx);
+  esp_wifi_set_promiscuous(true);
+
   while (!startupChase(WW_Color, 100)) {
     // wait for startup chase to finish
   }
@@ -99,63 +171,152 @@ void setup() {
 
 void loop() {
   static unsigned long lastPrint = 0;
-  static unsigned long lastLightUpdate = 0;
+  static uint32_t lastRenderUs = 0;
+  static uint32_t rendersAtPrint = 0, showsAtPrint = 0;
+  static unsigned long lastTelemetry = 0;
   unsigned long now = millis();
 
-  if (dmx.data[0] < 10 ) {
-    ledStrip.red = dmx.data[1];
-    ledStrip.green = dmx.data[2];
-    ledStrip.blue = dmx.data[3];
-    ledStrip.white = dmx.data[4];
-  } else if (dmx.data[0] >= 10 && dmx.data[0] < 20) {
-    // segment by segment control
-    updateSegmentsFromDMX();
+  handleSerialConfig();
+
+  if (now - lastTelemetry >= TELEMETRY_INTERVAL_MS) {
+    sendTelemetry(now - lastTelemetry);
+    lastTelemetry = now;
+  }
+
+  // work on a copy so a frame is never half old, half new
+  portENTER_CRITICAL(&dmxMux);
+  if (assembler.expire(now)) applyAssembledFrame();
+  DMXWindow frame = dmx;
+  portEXIT_CRITICAL(&dmxMux);
+
+  // a changed frame becomes the new target, faded to from what is shown now,
+  // so late or lost packets and slow consoles don't show up as steps
+  if (memcmp(frame.data, target.data, sizeof(frame.data)) != 0) {
+    memcpy(fadeFrom, shown.data, sizeof(fadeFrom));
+    target = frame;
+    targetUs = micros();
   }
 
   if (now - lastPrint >= 1000) {
     lastPrint = now;
     Serial.printf("Current DMX data: R=%d G=%d B=%d W=%d\n", 
                   ledStrip.red, ledStrip.green, ledStrip.blue, ledStrip.white);
+    Serial.printf("Frames: complete=%u partial=%u lost=%u timeouts=%u late fragments=%u missing base=%u decode errors=%u decode=%u us (max %u us)\n",
+                  assembler.framesComplete, assembler.framesPartial, assembler.framesLost,
+                  assembler.timeouts, assembler.lateFragments,
+                  assembler.missingBase, assembler.decodeErrors, decodeUs, maxDecodeUs);
+    uint32_t renders = renderCount - rendersAtPrint;
+    Serial.printf("Render: %u passes/s, %u shows/s, render=%u us avg (max %u us)\n",
+                  renders, showCount - showsAtPrint, renders ? renderUsSum / renders : 0, renderUsMax);
+    rendersAtPrint = renderCount;
+    showsAtPrint = showCount;
+    renderUsSum = 0;
+    renderUsMax = 0;
   }
 
-  if (now - lastLightUpdate >= 10) { // update light every 50ms for smooth breathing
-    lastLightUpdate = now;
-    if (dmx.data[0] < 10) {
+  // render at the strip's refresh rate, as soon as the last Show() is out;
+  // the strip is only refreshed when a pixel actually changed
+  uint32_t renderStart = micros();
+  if (renderStart - lastRenderUs >= STRIP_FRAME_US && strip.CanShow()) {
+    lastRenderUs = renderStart;
+    renderCount++;
+    interpolateFrame(micros() - targetUs);
+    if (shown.data[0] < 10) {
+      ledStrip.red = shown.data[1];
+      ledStrip.green = shown.data[2];
+      ledStrip.blue = shown.data[3];
+      ledStrip.white = shown.data[4];
       setLightOnStrip(RgbwColor(ledStrip.red, ledStrip.white, ledStrip.green, ledStrip.blue));
-    } else if (dmx.data[0] >= 10 && dmx.data[0] < 20)
+    } else if (shown.data[0] >= 10 && shown.data[0] < 20)
     {
       // control for segment by segment control
+      updateSegmentsFromDMX(shown);
       setSegments();
     }
-  }  
+    uint32_t renderUs = micros() - renderStart;
+    renderUsSum += renderUs;
+    if (renderUs > renderUsMax) renderUsMax = renderUs;
+  }
+}
+
+// Fade shown from fadeFrom towards target over the smoothing window.
+// The mode and the segment LED positions are not faded, they jump to the
+// target, and so does everything when the mode changes.
+void interpolateFrame(uint32_t elapsedUs) {
+  uint32_t windowUs = (uint32_t)rxConfig.smoothingMs * 1000;
+  uint32_t weight = (windowUs == 0 || elapsedUs >= windowUs) ? 256 : (uint64_t)elapsedUs * 256 / windowUs;
+  bool jump = weight == 256 || fadeFrom[0] != target.data[0];
+  bool segmentMode = target.data[0] >= 10 && target.data[0] < 20;
+
+  for (uint8_t i = 0; i < sizeof(shown.data); i++) {
+    bool position = i == 0 || (segmentMode && (i - 1) % 6 < 2);
+    if (jump || position) {
+      shown.data[i] = target.data[i];
+    } else {
+      int16_t diff = target.data[i] - fadeFrom[i];
+      shown.data[i] = fadeFrom[i] + diff * (int32_t)weight / 256;
+    }
+  }
 }
 
+// Paint the strip as spans between segment boundaries: each span takes the
+// colour of the last segment covering it, or goes dark, so no pixel is
+// cleared first and repainted.
 void setSegments() {
-  for (uint16_t i = 0; i < NUM_LEDS; i++) {
-    strip.SetPixelColor(i, RgbwColor(0, 0, 0, 0));
-  }
+  bool changed = false;
+  uint16_t first = 0;
+  while (first < NUM_LEDS) {
+    // the span ends where any segment starts or ends
+    uint16_t next = NUM_LEDS;
+    for (uint8_t s = 0; s < NUM_SEGMENTS; s++) {
+      if (segments[s].startLed > first && segments[s].startLed < next) next = segments[s].startLed;
+      if (segments[s].endLed >= first && segments[s].endLed + 1 < next) next = segments[s].endLed + 1;
+    }
 
-  for (uint8_t s = 0; s < NUM_SEGMENTS; s++) {
-    Segment seg = segments[s];
+    RgbwColor color(0, 0, 0, 0);
+    for (int8_t s = NUM_SEGMENTS - 1; s >= 0; s--) {
+      const Segment &seg = segments[s];
+      if (first >= seg.startLed && first <= seg.endLed) {
+        color = RgbwColor(seg.red, seg.white, seg.green, seg.blue);
+        break;
+      }
+    }
 
-    RgbwColor color(seg.red, seg.white, seg.green, seg.blue);
+    changed |= fillSpan(first, next - 1, color);
+    first = next;
+  }
+  showIfChanged(changed);
+}
 
-    for (uint16_t i = seg.startLed; i <= seg.endLed && i < NUM_LEDS; i++) {
+// Write color to LEDs first..last, skipping pixels that already have it.
+// Returns true if any pixel changed.
+bool fillSpan(uint16_t first, uint16_t last, RgbwColor color) {
+  bool changed = false;
+  for (uint16_t i = first; i <= last && i < NUM_LEDS; i++) {
+    if (strip.GetPixelColor(i) != color) {
       strip.SetPixelColor(i, color);
+      changed = true;
     }
   }
+  return changed;
+}
+
+// Send the pixel buffer to the strip only if it changed since the last Show()
+void showIfChanged(bool changed) {
+  if (!changed) return;
   strip.Show();
+  showCount++;
 }
 
-void updateSegmentsFromDMX() {
+void updateSegmentsFromDMX(const DMXWindow &frame) {
   uint8_t index = 1;
   for (uint8_t s = 0; s < NUM_SEGMENTS; s++) {
-    segments[s].startLed = dmx.data[index++];
-    segments[s].endLed = dmx.data[index++];
-    segments[s].red = dmx.data[index++];
-    segments[s].green = dmx.data[index++];
-    segments[s].blue = dmx.data[index++];
-    segments[s].white = dmx.data[index++];
+    segments[s].startLed = frame.data[index++];
+    segments[s].endLed = frame.data[index++];
+    segments[s].red = frame.data[index++];
+    segments[s].green = frame.data[index++];
+    segments[s].blue = frame.data[index++];
+    segments[s].white = frame.data[index++];
   }
 }
 
@@ -225,15 +386,7 @@ void breathe(RgbwColor baseColor, byte period, byte lowValue, byte highValue) {
 }
 
 void setLightOnStrip(RgbwColor color) {
-  RgbwColor scaledColor(
-      (uint8_t)(color.R),
-      (uint8_t)(color.G),
-      (uint8_t)(color.B),
-      (uint8_t)(color.W)
-    );
-    for (uint16_t i = 0; i < NUM_LEDS; i++) strip.SetPixelColor(i, scaledColor);
-    strip.Show();
-    return;
+  showIfChanged(fillSpan(0, NUM_LEDS - 1, color));
 }
 
 bool startupChase(RgbwColor color, unsigned long speedMs) {
@@ -273,8 +426,198 @@ bool startupChase(RgbwColor color, unsigned long speedMs) {
   return false;
 }
 
+// Fold the arrival of a frame's first fragment into the interval and jitter
+// averages. A change-driven bridge goes quiet while the console is static,
+// so an interval over twice the average is a gap (idle, keepalive or loss),
+// not jitter. Two gaps in a row mean the bridge settled on a slower cadence,
+// e.g. keepalives only, and the average starts over from it; so does it
+// after an interval under half the average, when the console starts moving.
+// Call with dmxMux held.
+void trackArrival(uint32_t arrivalUs) {
+  uint32_t last = linkStats.lastArrivalUs;
+  linkStats.lastArrivalUs = arrivalUs;
+  if (last == 0) return;
+
+  uint32_t interval = arrivalUs - last;
+  if (interval > 2 * linkStats.intervalUs && linkStats.lastIntervalUs != 0) {
+    linkStats.lastIntervalUs = 0;
+    return;
+  }
+  if (interval > 2 * linkStats.intervalUs || interval < linkStats.intervalUs / 2) {
+    linkStats.intervalUs = interval; // seed from the first sample of a cadence
+    linkStats.lastIntervalUs = 0;
+    linkStats.jitterSeeded = false;
+  }
+  if (linkStats.lastIntervalUs != 0) {
+    int32_t change = (int32_t)(interval - linkStats.lastIntervalUs);
+    if (change < 0) change = -change;
+    if (linkStats.jitterSeeded) {
+      linkStats.jitterUs += (change - (int32_t)linkStats.jitterUs) / 16;
+    } else {
+      linkStats.jitterUs = change;
+      linkStats.jitterSeeded = true;
+    }
+  }
+  linkStats.intervalUs += ((int32_t)interval - (int32_t)linkStats.intervalUs) / 16;
+  linkStats.lastIntervalUs = interval;
+}
+
 void onDataRecv(const uint8_t* mac, const uint8_t *incomingData, int len) {
-  memcpy(&dmx, incomingData, sizeof(DMXDataPacket));
-  Serial.printf("Received DMX data via ESP-NOW: MODE=%d R=%d G=%d B=%d W=%d\n", 
-                dmx.data[0], dmx.data[1], dmx.data[2], dmx.data[3], dmx.data[4]);
-}
\ No newline at end of file
+  // reject malformed packets, other bridges and other universes before touching dmx
+  const uint8_t *payload;
+  uint16_t size;
+  const DMXNowHeader *header = dmxNowDecode(incomingData, len, &payload, &size);
+  if (!header) return;
+
+  portENTER_CRITICAL(&dmxMux);
+  if (header->group != rxConfig.group || header->universe != rxConfig.universe) {
+    portEXIT_CRITICAL(&dmxMux);
+    return;
+  }
+  memcpy(linkStats.bridge, mac, 6);
+  linkStats.bridgeKnown = true;
+  if (memcmp(sniffedMac, mac, 6) == 0) {
+    linkStats.rssiSum += sniffedRssi;
+    linkStats.rssiCount++;
+  }
+
+  // every frame the bridge sends starts with fragment 0, complete or not
+  if (header->fragment == 0) trackArrival(micros());
+
+  uint32_t t0 = micros();
+  DMXNowAssembler::Result result = assembler.add(*header, payload, size, millis());
+  decodeUs = micros() - t0;
+  if (decodeUs > maxDecodeUs) maxDecodeUs = decodeUs;
+  if (result == DMXNowAssembler::FRAME_COMPLETE || result == DMXNowAssembler::FRAME_PARTIAL) {
+    applyAssembledFrame();
+  }
+  portEXIT_CRITICAL(&dmxMux);
+}
+
+// Copy this light's slots out of the reassembled universe in one go.
+// Call with dmxMux held.
+void applyAssembledFrame() {
+  uint16_t start = rxConfig.address ? rxConfig.address : assembler.getFrameStart();
+  uint16_t count = min((uint16_t)(DMXNOW_UNIVERSE_SLOTS + 1 - start), (uint16_t)sizeof(dmx.data));
+  memcpy(dmx.data, assembler.slots() + start - 1, count);
+  dmx.start = start;
+  dmx.count = count;
+  dmx.sequence = assembler.getSequence();
+}
+
+void loadReceiverConfig() {
+  prefs.begin("dmxlight", true);
+  rxConfig.group = prefs.getUChar("group", DMXNOW_GROUP_DEFAULT);
+  rxConfig.universe = prefs.getUChar("universe", DMX_UNIVERSE_DEFAULT);
+  rxConfig.address = min(prefs.getUShort("address", DMX_ADDRESS_DEFAULT), (uint16_t)DMXNOW_UNIVERSE_SLOTS);
+  rxConfig.smoothingMs = prefs.getUShort("smoothing", SMOOTHING_DEFAULT_MS);
+  prefs.end();
+}
+
+// Serial console: "group <0-255>", "universe <0-255>", "address <0-512>",
+// "smoothing <0-1000 ms>" or "config"
+void handleSerialConfig() {
+  if (!Serial.available()) return;
+
+  String line = Serial.readStringUntil('\n');
+  line.trim();
+  int space = line.indexOf(' ');
+  String cmd = space < 0 ? line : line.substring(0, space);
+  long value = space < 0 ? -1 : line.substring(space + 1).toInt();
+
+  if (cmd == "group" && value >= 0 && value <= 255) {
+    // another bridge numbers its frames on its own
+    portENTER_CRITICAL(&dmxMux);
+    if (rxConfig.group != value) assembler.reset();
+    rxConfig.group = value;
+    portEXIT_CRITICAL(&dmxMux);
+  } else if (cmd == "universe" && value >= 0 && value <= 255) {
+    // fragments and delta bases of the old universe must not mix into the new one
+    portENTER_CRITICAL(&dmxMux);
+    if (rxConfig.universe != value) assembler.reset();
+    rxConfig.universe = value;
+    portEXIT_CRITICAL(&dmxMux);
+  } else if (cmd == "address" && value >= 0 && value <= DMXNOW_UNIVERSE_SLOTS) {
+    portENTER_CRITICAL(&dmxMux);
+    rxConfig.address = value;
+    applyAssembledFrame();
+    portEXIT_CRITICAL(&dmxMux);
+  } else if (cmd == "smoothing" && value >= 0 && value <= 1000) {
+    rxConfig.smoothingMs = value;
+  } else if (cmd != "config") {
+    Serial.println("Commands: group <0-255>, universe <0-255>, address <0-512> (0 = window start), smoothing <0-1000 ms>, config");
+    return;
+  }
+
+  if (cmd != "config") {
+    prefs.begin("dmxlight", false);
+    prefs.putUChar("group", rxConfig.group);
+    prefs.putUChar("universe", rxConfig.universe);
+    prefs.putUShort("address", rxConfig.address);
+    prefs.putUShort("smoothing", rxConfig.smoothingMs);
+    prefs.end();
+  }
+  Serial.printf("Light %s: group=%u universe=%u address=%u smoothing=%u ms\n", WiFi.macAddress().c_str(),
+                rxConfig.group, rxConfig.universe, rxConfig.address, rxConfig.smoothingMs);
+}
+
+// Remember the signal strength of each ESP-NOW frame; onDataRecv() runs
+// right after for the same frame and keeps it if it came from the bridge.
+void onPromiscuousRx(void *buf, wifi_promiscuous_pkt_type_t type) {
+  if (type != WIFI_PKT_MGMT) return;
+  const wifi_promiscuous_pkt_t *pkt = (const wifi_promiscuous_pkt_t *)buf;
+  if (pkt->rx_ctrl.sig_len < 25) return; // too short for the action category byte
+  const uint8_t *frame = pkt->payload;
+  if (frame[0] != 0xD0 || frame[24] != 127) return; // vendor-specific action frame
+  memcpy(sniffedMac, frame + 10, 6);                // transmitter address
+  sniffedRssi = pkt->rx_ctrl.rssi;
+}
+
+// Send what this light received since the last report to the bridge it
+// follows. Counts are per period, so the bridge keeps no history.
+void sendTelemetry(unsigned long periodMs) {
+  static uint32_t lastComplete = 0, lastPartial = 0, lastLost = 0; // counters at the previous report
+  static uint32_t lastShows = 0;
+
+  DMXNowTelemetry report = {};
+  uint8_t bridge[6];
+
+  portENTER_CRITICAL(&dmxMux);
+  bool known = linkStats.bridgeKnown;
+  memcpy(bridge, linkStats.bridge, 6);
+  uint32_t partial = assembler.framesPartial + assembler.timeouts;
+  report.framesComplete = assembler.framesComplete - lastComplete;
+  report.framesPartial = partial - lastPartial;
+  report.framesLost = assembler.framesLost - lastLost;
+  lastComplete = assembler.framesComplete;
+  lastPartial = partial;
+  lastLost = assembler.framesLost;
+  report.intervalUs = linkStats.intervalUs;
+  report.jitterUs = linkStats.jitterUs;
+  report.rssi = linkStats.rssiCount ? linkStats.rssiSum / linkStats.rssiCount : 0;
+  linkStats.rssiSum = 0;
+  linkStats.rssiCount = 0;
+  portEXIT_CRITICAL(&dmxMux);
+
+  // strip refreshes, an unchanging strip is not refreshed at all
+  report.renderFps = min((showCount - lastShows) * 1000 / periodMs, (unsigned long)255);
+  lastShows = showCount;
+  if (!known) return;
+
+  report.magic = DMXNOW_TELEMETRY_MAGIC;
+  report.version = DMXNOW_VERSION;
+  report.group = rxConfig.group;
+  report.universe = rxConfig.universe;
+  report.address = rxConfig.address;
+  report.periodMs = min(periodMs, (unsigned long)0xFFFF);
+
+  // unicast so only the bridge wakes up for it, and it gets ACKed
+  if (!esp_now_is_peer_exist(bridge)) {
+    esp_now_peer_info_t peer = {};
+    memcpy(peer.peer_addr, bridge, 6);
+    peer.channel = 0; // use current channel
+    peer.encrypt = false;
+    esp_now_add_peer(&peer);
+  }
+  esp_now_send(bridge, (const uint8_t *)&report, sizeof(report));
+}